@@ -1,5 +1,7 @@
 @vs vs
 in vec2 position;
+in vec4 instanceTransform;
+in vec2 instanceOffset;
 out vec2 vxPosition;
 
 uniform vs_params
@@ -11,7 +13,9 @@ uniform vs_params
 
 void main() {
     vec4 p      = vec4(position, 0.0, 1.0);
-    gl_Position = projection * transform * p;
+    vec4 world  = transform * p;
+    world.xy    = mat2(instanceTransform.xy, instanceTransform.zw) * world.xy + instanceOffset;
+    gl_Position = projection * world;
     vxPosition  = (transformLocal * p).xy;
 }
 @end
@@ -106,7 +110,37 @@ void main()
 }
 @end
 
+@vs vs_batch
+in vec2 position;
+in vec4 color;
+in vec4 instanceTransform;
+in vec2 instanceOffset;
+out vec4 vxColor;
+
+uniform vs_batch_params
+{
+    mat4 projection;
+};
+
+void main() {
+    vec2 world  = mat2(instanceTransform.xy, instanceTransform.zw) * position + instanceOffset;
+    gl_Position = projection * vec4(world, 0.0, 1.0);
+    vxColor     = color;
+}
+@end
+
+@fs fs_batch
+in vec4  vxColor;
+out vec4 fragColor;
+
+void main()
+{
+    fragColor = vec4(vxColor.rgb * vxColor.a, vxColor.a);
+}
+@end
+
 @program rive_shader        vs fs
 @program rive_debug_contour vs debug_contour
+@program rive_batch         vs_batch fs_batch
 
 
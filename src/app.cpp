@@ -1,14 +1,21 @@
+#include <float.h>
+#include <math.h>
 #include <stdio.h>
 
-#include <imgui.h>
-
 #define SOKOL_IMPL
-#define SOKOL_GLCORE33
+#if defined(RIVE_SOKOL_HEADLESS)
+    #define SOKOL_DUMMY_BACKEND
+#else
+    #define SOKOL_GLCORE33
+#endif
 #include <sokol_gfx.h>
 #include <sokol_time.h>
 
-#define GLFW_INCLUDE_NONE
-#include <GLFW/glfw3.h>
+#if !defined(RIVE_SOKOL_HEADLESS)
+    #include <imgui.h>
+    #define GLFW_INCLUDE_NONE
+    #include <GLFW/glfw3.h>
+#endif
 
 #include <jc/array.h>
 #include <jc/hashtable.h>
@@ -23,13 +30,20 @@
 
 #define VIEWER_WINDOW_NAME "Rive Sokol Viewer"
 
-typedef ImVec2 vs_imgui_params_t;
+#if defined(RIVE_SOKOL_HEADLESS)
+    // The dummy backend doesn't compile anything, so it is fine to hand it the GL sources
+    #define VIEWER_SHADER_BACKEND SG_BACKEND_GLCORE33
+#else
+    #define VIEWER_SHADER_BACKEND sg_query_backend()
+    typedef ImVec2 vs_imgui_params_t;
+#endif
 
 static struct App
 {
     static const int MAX_ARTBOARD_CONTEXTS = 8;
     static const int MAX_IMGUI_VERTICES    = (1<<16);
     static const int MAX_IMGUI_INDICES     = MAX_IMGUI_VERTICES * 3;
+    static const uint32_t INVALID_PAINT_ID = 0xffffffff;
 
     enum DebugView
     {
@@ -56,6 +70,51 @@ static struct App
         int32_t                 m_CloneCount;
     };
 
+    // One artboard to advance and record, into its own command list when recording in parallel
+    struct DrawJob
+    {
+        const ArtboardData* m_Data;
+        rive::HRenderer     m_Renderer;
+        float               m_Dt;
+        float               m_X;
+        float               m_Y;
+        uint32_t            m_InstanceStart;
+        uint32_t            m_InstanceCount;
+    };
+
+    struct Transform
+    {
+        mat4x4 m_Matrix;
+    };
+
+    // Per instance vertex data, a 2x2 matrix and a translation applied in world space
+    struct Instance
+    {
+        float m_Transform[4];
+        float m_Offset[2];
+    };
+
+    // Pixel rect with the origin top left, empty when x1 <= x0 or y1 <= y0
+    struct Rect
+    {
+        int m_X0;
+        int m_Y0;
+        int m_X1;
+        int m_Y1;
+    };
+
+    // Opaque draw of the tessellation front to back pass, with the state it is drawn
+    // with and its position in painter's order
+    struct OpaqueDraw
+    {
+        rive::PathDrawEvent m_Event;
+        Rect                m_ScissorRect;
+        uint32_t            m_PaintId;
+        uint32_t            m_InstanceOffset;
+        uint32_t            m_InstanceCount;
+        uint32_t            m_Order;
+    };
+
     struct GpuBuffer
     {
         sg_buffer    m_Handle;
@@ -84,15 +143,29 @@ static struct App
 
     // Rive
     rive::HContext             m_Ctx;
+    rive::HThreadPool          m_ThreadPool;
+    uint32_t                   m_JobThreadCount;
+    bool                       m_JobsDisabled;
     ArtboardContext            m_ArtboardContexts[MAX_ARTBOARD_CONTEXTS];
     rive::HRenderer            m_Renderer;
+    jc::Array<rive::HRenderer> m_CommandLists;
+    jc::Array<DrawJob>         m_DrawJobs;
+#if !defined(RIVE_SOKOL_HEADLESS)
     // GLFW
     GLFWwindow*                m_Window;
+#endif
     // Sokol
     sg_shader                  m_MainShader;
+    sg_shader                  m_BatchShader;
     sg_pipeline                m_TessellationIsClippingPipelines[256];
+    sg_pipeline                m_BatchIsClippingPipelines[256];
+    sg_pipeline                m_TessellationClipPushPipelines[256];
+    sg_pipeline                m_TessellationClipPopPipelines[256];
+    sg_pipeline                m_BatchPipeline;
     sg_pipeline                m_TessellationPipeline;
-    sg_pipeline                m_TessellationApplyClippingPipeline;
+    sg_pipeline                m_BatchOpaquePipeline;
+    sg_pipeline                m_StrokeOpaquePipeline;
+    sg_pipeline                m_TessellationOpaquePipeline;
     sg_pipeline                m_StencilPipelineNonClippingCCW;
     sg_pipeline                m_StencilPipelineNonClippingCW;
     sg_pipeline                m_StencilPipelineClippingCCW;
@@ -100,6 +173,8 @@ static struct App
     sg_pipeline                m_StencilPipelineCoverNonClipping;
     sg_pipeline                m_StencilPipelineCoverClipping;
     sg_pipeline                m_StencilPipelineCoverIsApplyingCLipping;
+    sg_pipeline                m_StencilClearPipeline;
+    sg_buffer                  m_StencilClearVertexBuffer;
     sg_pipeline                m_StrokePipeline;
     sg_pass_action             m_PassAction;
     sg_bindings                m_Bindings;
@@ -114,6 +189,24 @@ static struct App
     Camera                     m_Camera;
     DebugView                  m_DebugView;
     DebugViewData              m_DebugViewData;
+    rive::RecordingFormat      m_RecordingFormat;
+    bool                       m_Batching;
+    bool                       m_Instancing;
+    bool                       m_ClipRetention;
+    bool                       m_Culling;
+    bool                       m_PauseOffscreen;
+    bool                       m_OpaquePass;
+    // Stencil region written by the clips, and the view it was written with.
+    // It is kept across frames while clip retention is enabled.
+    Rect                       m_StencilRect;
+    Camera                     m_StencilCamera;
+    uint32_t                   m_StencilWidth;
+    uint32_t                   m_StencilHeight;
+    jc::Array<Transform>       m_TransformPalette;
+    jc::Array<rive::Mat2D>     m_InstanceTransforms;
+    jc::Array<Instance>        m_Instances;
+    jc::Array<OpaqueDraw>      m_OpaqueDraws;
+    GpuBuffer*                 m_InstanceBuffer;
 } g_app;
 
 namespace rive
@@ -171,6 +264,14 @@ rive::Artboard* LoadArtboardFromData(uint8_t* data, size_t dataLength)
     return file->artboard();
 }
 
+// Paths of deleted artboards can be reallocated for new ones, so clips retained in
+// the stencil buffer are dropped on the next frame.
+static void InvalidateStencil()
+{
+    g_app.m_StencilWidth  = 0;
+    g_app.m_StencilHeight = 0;
+}
+
 static void UpdateArtboardCloneCount(App::ArtboardContext& ctx)
 {
     if (ctx.m_CloneCount != (int) ctx.m_Artboards.Size())
@@ -186,6 +287,13 @@ static void UpdateArtboardCloneCount(App::ArtboardContext& ctx)
             if (artboard->animationCount() > 0)
             {
                 data.m_AnimationInstance = new rive::LinearAnimationInstance(artboard->firstAnimation());
+
+                // New clones start where the first one is, so they can be drawn as instances of it
+                rive::LinearAnimationInstance* first = ctx.m_Artboards[0].m_AnimationInstance;
+                if (first)
+                {
+                    data.m_AnimationInstance->time(first->time());
+                }
             }
 
             ctx.m_Artboards.SetCapacity(ctx.m_Artboards.Capacity() + 1);
@@ -207,6 +315,7 @@ static void UpdateArtboardCloneCount(App::ArtboardContext& ctx)
             }
 
             ctx.m_Artboards.SetSize(ctx.m_CloneCount);
+            InvalidateStencil();
         }
     }
 }
@@ -306,9 +415,11 @@ static void RemoveArtboardContext(uint8_t index)
 
     ctx.m_Artboards.SetSize(0);
     ctx.m_Artboards.SetCapacity(0);
+    delete[] ctx.m_Data;
     ctx.m_Data       = 0;
     ctx.m_DataSize   = 0;
     ctx.m_CloneCount = 0;
+    InvalidateStencil();
 }
 
 static inline void Mat2DToMat4(const rive::Mat2D m2, mat4x4 m4)
@@ -334,6 +445,27 @@ static inline void Mat2DToMat4(const rive::Mat2D m2, mat4x4 m4)
     m4[3][3] = 1.0;
 }
 
+// Converts the renderer's transform palette once per frame, draws copy from it by index
+static void UpdateTransformPalette()
+{
+    const rive::TransformPalette palette = rive::getTransformPalette(g_app.m_Renderer);
+    if (g_app.m_TransformPalette.Capacity() < palette.m_Count)
+    {
+        g_app.m_TransformPalette.SetCapacity(palette.m_Count);
+    }
+
+    g_app.m_TransformPalette.SetSize(palette.m_Count);
+    for (uint32_t i = 0; i < palette.m_Count; ++i)
+    {
+        Mat2DToMat4(palette.m_Transforms[i], g_app.m_TransformPalette[i].m_Matrix);
+    }
+}
+
+static inline void GetPaletteTransform(uint32_t idx, mat4x4 m4)
+{
+    mat4x4_dup(m4, g_app.m_TransformPalette[idx].m_Matrix);
+}
+
 static rive::HBuffer AppRequestBufferCallback(rive::HBuffer buffer, rive::BufferType type, void* data, unsigned int dataSize, void* userData)
 {
     if (dataSize == 0)
@@ -387,6 +519,40 @@ static void AppDestroyBufferCallback(rive::HBuffer buffer, void* userData)
     }
 }
 
+// Entry 0 is always the identity instance, the renderer's instance list follows it
+static void UpdateInstanceBuffer()
+{
+    const rive::InstanceList instances = rive::getInstances(g_app.m_Renderer);
+    if (g_app.m_Instances.Capacity() < instances.m_Count + 1)
+    {
+        g_app.m_Instances.SetCapacity(instances.m_Count + 1);
+    }
+
+    g_app.m_Instances.SetSize(0);
+    g_app.m_Instances.Push({ .m_Transform = { 1.0f, 0.0f, 0.0f, 1.0f }, .m_Offset = { 0.0f, 0.0f } });
+
+    for (uint32_t i = 0; i < instances.m_Count; ++i)
+    {
+        const rive::Mat2D& m = instances.m_Transforms[i];
+        g_app.m_Instances.Push({ .m_Transform = { m[0], m[1], m[2], m[3] }, .m_Offset = { m[4], m[5] } });
+    }
+
+    g_app.m_InstanceBuffer = (App::GpuBuffer*) AppRequestBufferCallback((rive::HBuffer) g_app.m_InstanceBuffer,
+        rive::BUFFER_TYPE_VERTEX_BUFFER, g_app.m_Instances.Begin(), g_app.m_Instances.Size() * sizeof(App::Instance), 0);
+
+    g_app.m_Bindings.vertex_buffers[1]        = g_app.m_InstanceBuffer->m_Handle;
+    g_app.m_Bindings.vertex_buffer_offsets[1] = 0;
+}
+
+// All pipelines read the instance data from vertex buffer slot 1
+static void SetInstanceLayout(sg_pipeline_desc& desc, int transformAttr, int offsetAttr)
+{
+    desc.layout.buffers[1].step_func = SG_VERTEXSTEP_PER_INSTANCE;
+    desc.layout.attrs[transformAttr] = { .buffer_index = 1, .format = SG_VERTEXFORMAT_FLOAT4 };
+    desc.layout.attrs[offsetAttr]    = { .buffer_index = 1, .format = SG_VERTEXFORMAT_FLOAT2 };
+}
+
+#if !defined(RIVE_SOKOL_HEADLESS)
 static void AppCursorCallback(GLFWwindow* w, double x, double y)
 {
     ImGui::GetIO().MousePos.x = float(x);
@@ -413,9 +579,11 @@ static void AppDropCallback(GLFWwindow* window, int count, const char** paths)
         AddArtboardFromPath(paths[i]);
     }
 }
+#endif
 
 bool AppBootstrap(int argc, char const *argv[])
 {
+#if !defined(RIVE_SOKOL_HEADLESS)
     ////////////////////////////////////////////////////
     // GLFW setup
     ////////////////////////////////////////////////////
@@ -443,9 +611,12 @@ bool AppBootstrap(int argc, char const *argv[])
 
     glfwMakeContextCurrent(window);
     glfwSwapInterval(1);
+#endif
 
     memset((void*)&g_app, 0, sizeof(g_app));
+#if !defined(RIVE_SOKOL_HEADLESS)
     g_app.m_Window = window;
+#endif
     g_app.m_Camera.Reset();
 
     ////////////////////////////////////////////////////
@@ -459,43 +630,21 @@ bool AppBootstrap(int argc, char const *argv[])
 
     // Main tessellation pipeline
     sg_pipeline_desc tessellationPipeline               = {};
-    tessellationPipeline.shader                         = sg_make_shader(rive_shader_shader_desc(sg_query_backend()));
+    tessellationPipeline.shader                         = sg_make_shader(rive_shader_shader_desc(VIEWER_SHADER_BACKEND));
     tessellationPipeline.index_type                     = SG_INDEXTYPE_UINT32;
     tessellationPipeline.layout.attrs[0]                = { .format = SG_VERTEXFORMAT_FLOAT2 };
+    SetInstanceLayout(tessellationPipeline, ATTR_vs_instanceTransform, ATTR_vs_instanceOffset);
     tessellationPipeline.colors[0].blend.enabled        = true;
     tessellationPipeline.colors[0].blend.src_factor_rgb = SG_BLENDFACTOR_SRC_ALPHA;
     tessellationPipeline.colors[0].blend.dst_factor_rgb = SG_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
-
-    sg_pipeline_desc tessellationApplyingClippingPipeline     = {};
-    tessellationApplyingClippingPipeline.shader               = tessellationPipeline.shader;
-    tessellationApplyingClippingPipeline.index_type           = SG_INDEXTYPE_UINT32;
-    tessellationApplyingClippingPipeline.layout.attrs[0]      = { .format = SG_VERTEXFORMAT_FLOAT2 };
-    tessellationApplyingClippingPipeline.colors[0].write_mask = SG_COLORMASK_NONE;
-
-    tessellationApplyingClippingPipeline.stencil = {
-        .enabled = true,
-        .front = {
-            .compare       = SG_COMPAREFUNC_ALWAYS,
-            .fail_op       = SG_STENCILOP_KEEP,
-            .depth_fail_op = SG_STENCILOP_KEEP,
-            .pass_op       = SG_STENCILOP_INCR_CLAMP,
-        },
-        .back = {
-            .compare       = SG_COMPAREFUNC_ALWAYS,
-            .fail_op       = SG_STENCILOP_KEEP,
-            .depth_fail_op = SG_STENCILOP_KEEP,
-            .pass_op       = SG_STENCILOP_INCR_CLAMP,
-        },
-        .read_mask  = 0xFF,
-        .write_mask = 0xFF,
-        .ref        = 0x0,
-    };
+    tessellationPipeline.depth.compare                  = SG_COMPAREFUNC_LESS_EQUAL;
 
     // Stencil to cover pipelines
     sg_pipeline_desc pipelineStencilDesc               = {};
     pipelineStencilDesc.shader                         = tessellationPipeline.shader;
     pipelineStencilDesc.index_type                     = SG_INDEXTYPE_UINT32;
     pipelineStencilDesc.layout.attrs[0]                = { .format = SG_VERTEXFORMAT_FLOAT2 };
+    SetInstanceLayout(pipelineStencilDesc, ATTR_vs_instanceTransform, ATTR_vs_instanceOffset);
     pipelineStencilDesc.colors[0].blend.enabled        = true;
     pipelineStencilDesc.colors[0].blend.src_factor_rgb = SG_BLENDFACTOR_SRC_ALPHA;
     pipelineStencilDesc.colors[0].blend.dst_factor_rgb = SG_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
@@ -580,21 +729,89 @@ bool AppBootstrap(int argc, char const *argv[])
     g_app.m_StencilPipelineCoverClipping           = coverPipelineClipping;
     g_app.m_StencilPipelineCoverIsApplyingCLipping = coverPipelineIsApplyingClipping;
 
+    // Stencil clear pipeline, zeroes the stencil buffer under a scissored fullscreen quad
+    // so that clipping doesn't have to restart the pass to clear it.
+    const float stencilClearVertices[] = {
+        -1.0f, -1.0f,  1.0f, -1.0f,
+        -1.0f,  1.0f,  1.0f,  1.0f,
+    };
+
+    sg_buffer_desc stencilClearBufferDesc = {
+        .data = SG_RANGE(stencilClearVertices),
+    };
+
+    sg_pipeline_desc stencilClearPipelineDesc     = {};
+    stencilClearPipelineDesc.shader               = tessellationPipeline.shader;
+    stencilClearPipelineDesc.primitive_type       = SG_PRIMITIVETYPE_TRIANGLE_STRIP;
+    stencilClearPipelineDesc.index_type           = SG_INDEXTYPE_NONE;
+    stencilClearPipelineDesc.layout.attrs[0]      = { .format = SG_VERTEXFORMAT_FLOAT2 };
+    SetInstanceLayout(stencilClearPipelineDesc, ATTR_vs_instanceTransform, ATTR_vs_instanceOffset);
+    stencilClearPipelineDesc.colors[0].write_mask = SG_COLORMASK_NONE;
+
+    stencilClearPipelineDesc.stencil = {
+        .enabled = true,
+        .front = {
+            .compare       = SG_COMPAREFUNC_ALWAYS,
+            .fail_op       = SG_STENCILOP_KEEP,
+            .depth_fail_op = SG_STENCILOP_KEEP,
+            .pass_op       = SG_STENCILOP_ZERO,
+        },
+        .back = {
+            .compare       = SG_COMPAREFUNC_ALWAYS,
+            .fail_op       = SG_STENCILOP_KEEP,
+            .depth_fail_op = SG_STENCILOP_KEEP,
+            .pass_op       = SG_STENCILOP_ZERO,
+        },
+        .read_mask  = 0xFF,
+        .write_mask = 0xFF,
+        .ref        = 0x0,
+    };
+
+    g_app.m_StencilClearPipeline     = sg_make_pipeline(&stencilClearPipelineDesc);
+    g_app.m_StencilClearVertexBuffer = sg_make_buffer(&stencilClearBufferDesc);
+
     // Stroke pipeline
     sg_pipeline_desc strokePipeline               = {};
     strokePipeline.shader                         = tessellationPipeline.shader;
     strokePipeline.primitive_type                 = SG_PRIMITIVETYPE_TRIANGLE_STRIP;
     strokePipeline.index_type                     = SG_INDEXTYPE_NONE;
     strokePipeline.layout.attrs[0]                = { .format = SG_VERTEXFORMAT_FLOAT2 };
+    SetInstanceLayout(strokePipeline, ATTR_vs_instanceTransform, ATTR_vs_instanceOffset);
     strokePipeline.colors[0].blend.enabled        = true;
     strokePipeline.colors[0].blend.src_factor_rgb = SG_BLENDFACTOR_SRC_ALPHA;
     strokePipeline.colors[0].blend.dst_factor_rgb = SG_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
+    strokePipeline.depth.compare                  = SG_COMPAREFUNC_LESS_EQUAL;
+
+    // Batch pipeline, pre-transformed vertices with a per vertex color
+    sg_pipeline_desc batchPipeline               = {};
+    batchPipeline.shader                         = sg_make_shader(rive_batch_shader_desc(VIEWER_SHADER_BACKEND));
+    batchPipeline.index_type                     = SG_INDEXTYPE_UINT32;
+    batchPipeline.layout.attrs[0]                = { .format = SG_VERTEXFORMAT_FLOAT2 };
+    batchPipeline.layout.attrs[1]                = { .format = SG_VERTEXFORMAT_UBYTE4N };
+    SetInstanceLayout(batchPipeline, ATTR_vs_batch_instanceTransform, ATTR_vs_batch_instanceOffset);
+    batchPipeline.colors[0].blend.enabled        = true;
+    batchPipeline.colors[0].blend.src_factor_rgb = SG_BLENDFACTOR_SRC_ALPHA;
+    batchPipeline.colors[0].blend.dst_factor_rgb = SG_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
+    batchPipeline.depth.compare                  = SG_COMPAREFUNC_LESS_EQUAL;
+
+    // Opaque pipelines for the front to back pass, the depth test rejects what they hide
+    // instead of blending over it.
+    sg_pipeline_desc tessellationOpaquePipeline          = tessellationPipeline;
+    tessellationOpaquePipeline.colors[0].blend.enabled   = false;
+    tessellationOpaquePipeline.depth.write_enabled       = true;
+    sg_pipeline_desc strokeOpaquePipeline                = strokePipeline;
+    strokeOpaquePipeline.colors[0].blend.enabled         = false;
+    strokeOpaquePipeline.depth.write_enabled             = true;
+    sg_pipeline_desc batchOpaquePipeline                 = batchPipeline;
+    batchOpaquePipeline.colors[0].blend.enabled          = false;
+    batchOpaquePipeline.depth.write_enabled              = true;
 
     // Debug pipelines
     sg_pipeline_desc debugViewContourPipelineDesc               = {};
-    debugViewContourPipelineDesc.shader                         = sg_make_shader(rive_debug_contour_shader_desc(sg_query_backend()));
+    debugViewContourPipelineDesc.shader                         = sg_make_shader(rive_debug_contour_shader_desc(VIEWER_SHADER_BACKEND));
     debugViewContourPipelineDesc.index_type                     = SG_INDEXTYPE_UINT32;
     debugViewContourPipelineDesc.layout.attrs[0]                = { .format = SG_VERTEXFORMAT_FLOAT2 };
+    SetInstanceLayout(debugViewContourPipelineDesc, ATTR_vs_instanceTransform, ATTR_vs_instanceOffset);
     debugViewContourPipelineDesc.colors[0].blend.enabled        = true;
     debugViewContourPipelineDesc.colors[0].blend.src_factor_rgb = SG_BLENDFACTOR_SRC_ALPHA;
     debugViewContourPipelineDesc.colors[0].blend.dst_factor_rgb = SG_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
@@ -605,9 +822,13 @@ bool AppBootstrap(int argc, char const *argv[])
     passAction.colors[0].value  = { 0.25f, 0.25f, 0.25f, 1.0f};
 
     g_app.m_MainShader                        = tessellationPipeline.shader;
+    g_app.m_BatchShader                       = batchPipeline.shader;
+    g_app.m_BatchPipeline                     = sg_make_pipeline(&batchPipeline);
     g_app.m_StrokePipeline                    = sg_make_pipeline(&strokePipeline);
     g_app.m_TessellationPipeline              = sg_make_pipeline(&tessellationPipeline);
-    g_app.m_TessellationApplyClippingPipeline = sg_make_pipeline(&tessellationApplyingClippingPipeline);
+    g_app.m_BatchOpaquePipeline               = sg_make_pipeline(&batchOpaquePipeline);
+    g_app.m_StrokeOpaquePipeline              = sg_make_pipeline(&strokeOpaquePipeline);
+    g_app.m_TessellationOpaquePipeline        = sg_make_pipeline(&tessellationOpaquePipeline);
     g_app.m_DebugViewContourPipeline          = sg_make_pipeline(&debugViewContourPipelineDesc);
     g_app.m_PassAction                        = passAction;
     g_app.m_Bindings                          = {};
@@ -615,17 +836,31 @@ bool AppBootstrap(int argc, char const *argv[])
     ////////////////////////////////////////////////////
     // Rive setup
     ////////////////////////////////////////////////////
-    g_app.m_Ctx = rive::createContext();
+    // Dirty paths are prepared on a thread pool unless the job system was disabled
+    if (!g_app.m_JobsDisabled)
+    {
+        g_app.m_ThreadPool = rive::createThreadPool(g_app.m_JobThreadCount);
+    }
+
+    const rive::JobSystem jobSystem = rive::getJobSystem(g_app.m_ThreadPool);
+    g_app.m_Ctx = rive::createContext(g_app.m_ThreadPool ? &jobSystem : 0);
     rive::setBufferCallbacks(g_app.m_Ctx, AppRequestBufferCallback, AppDestroyBufferCallback);
     rive::setRenderMode(g_app.m_Ctx, rive::MODE_STENCIL_TO_COVER);
     g_app.m_Renderer = rive::createRenderer(g_app.m_Ctx);
     rive::setClippingSupport(g_app.m_Renderer, true);
+    g_app.m_Batching       = true;
+    g_app.m_Instancing     = true;
+    g_app.m_ClipRetention  = false;
+    g_app.m_Culling        = true;
+    g_app.m_PauseOffscreen = false;
+    g_app.m_OpaquePass     = false;
 
     for (int i = 1; i < argc; ++i)
     {
         AddArtboardFromPath(argv[i]);
     }
 
+#if !defined(RIVE_SOKOL_HEADLESS)
     ////////////////////////////////////////////////////
     // Imgui setup
     ////////////////////////////////////////////////////
@@ -702,57 +937,234 @@ bool AppBootstrap(int argc, char const *argv[])
     imguiPipelineDesc.colors[0].blend.dst_factor_rgb = SG_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
     imguiPipelineDesc.colors[0].write_mask           = SG_COLORMASK_RGB;
     g_app.m_ImguiPipeline                            = sg_make_pipeline(&imguiPipelineDesc);
+#endif
+    return true;
+}
+
+static void DrawArtboard(const App::DrawJob& job)
+{
+    rive::Renderer* renderer                 = (rive::Renderer*) job.m_Renderer;
+    rive::Artboard* artboard                 = job.m_Data->m_Artboard;
+    rive::LinearAnimationInstance* animation = job.m_Data->m_AnimationInstance;
+    rive::AABB artboardBounds                = artboard->bounds();
+
+    if (job.m_InstanceCount > 0)
+    {
+        rive::setInstances(job.m_Renderer, &g_app.m_InstanceTransforms[job.m_InstanceStart], job.m_InstanceCount);
+    }
+
+    renderer->save();
+    renderer->align(rive::Fit::none,
+       rive::Alignment::topLeft,
+       rive::AABB(job.m_X, job.m_Y, artboardBounds.width(), artboardBounds.height()),
+       artboardBounds);
+
+    // The artboard is taken to stay within its bounds, when they are off-screen
+    // it is neither animated nor drawn if pausing is enabled.
+    if (!g_app.m_PauseOffscreen || !rive::isCulled(job.m_Renderer,
+        artboardBounds.minX(), artboardBounds.minY(), artboardBounds.maxX(), artboardBounds.maxY()))
+    {
+        if (animation)
+        {
+            animation->advance(job.m_Dt);
+            animation->apply(artboard, 1);
+        }
+
+        artboard->advance(job.m_Dt);
+        artboard->draw(renderer);
+
+        // The clones drawn as instances of this one keep their own animation time, so
+        // they don't jump when they are drawn on their own again
+        for (uint32_t i = 1; i < job.m_InstanceCount; ++i)
+        {
+            if (job.m_Data[i].m_AnimationInstance)
+            {
+                job.m_Data[i].m_AnimationInstance->advance(job.m_Dt);
+            }
+        }
+    }
+    renderer->restore();
+
+    if (job.m_InstanceCount > 0)
+    {
+        rive::setInstances(job.m_Renderer, &rive::Mat2D::identity(), 1);
+    }
+}
+
+static void DrawArtboardJob(void* jobData, uint32_t jobIndex)
+{
+    const App::DrawJob& job = ((const App::DrawJob*) jobData)[jobIndex];
+    rive::newFrame(job.m_Renderer);
+    DrawArtboard(job);
+}
+
+static void DestroyCommandLists()
+{
+    for (uint32_t i = 0; i < g_app.m_CommandLists.Size(); ++i)
+    {
+        rive::destroyRenderer(g_app.m_CommandLists[i]);
+    }
+    g_app.m_CommandLists.SetSize(0);
+}
+
+// Clones can only be drawn as instances of the first one while they all show the same pose
+static bool IsCloneAnimationSynced(const App::ArtboardContext& ctx)
+{
+    const rive::LinearAnimationInstance* first = ctx.m_Artboards[0].m_AnimationInstance;
+    for (int i = 1; i < (int) ctx.m_Artboards.Size(); ++i)
+    {
+        const rive::LinearAnimationInstance* animation = ctx.m_Artboards[i].m_AnimationInstance;
+        if ((first == 0) != (animation == 0) || (first && first->time() != animation->time()))
+        {
+            return false;
+        }
+    }
     return true;
 }
 
 void AppUpdateRive(float dt, uint32_t width, uint32_t height)
 {
+    rive::setClipRetention(g_app.m_Renderer, g_app.m_ClipRetention);
     rive::newFrame(g_app.m_Renderer);
-    rive::Renderer* renderer = (rive::Renderer*) g_app.m_Renderer;
+
+    // Retained clips are only valid while they land on the same pixels as last frame
+    const bool keepStencil = g_app.m_ClipRetention && rive::getClippingSupport(g_app.m_Renderer) &&
+        g_app.m_StencilWidth == width && g_app.m_StencilHeight == height &&
+        g_app.m_StencilCamera.m_X == g_app.m_Camera.m_X &&
+        g_app.m_StencilCamera.m_Y == g_app.m_Camera.m_Y &&
+        g_app.m_StencilCamera.m_Zoom == g_app.m_Camera.m_Zoom;
+
+    if (!keepStencil)
+    {
+        rive::resetClipping(g_app.m_Renderer);
+        g_app.m_StencilRect = {};
+    }
+
+    g_app.m_PassAction.stencil.action = keepStencil ? SG_ACTION_LOAD : SG_ACTION_CLEAR;
+    g_app.m_StencilCamera             = g_app.m_Camera;
+    g_app.m_StencilWidth              = width;
+    g_app.m_StencilHeight             = height;
+
+    // The camera zoom is in units per pixel
+    rive::setContourScale(g_app.m_Renderer, 1.0f / g_app.m_Camera.Zoom());
+
+    // Culls against the view in world space, see GetCameraMatrix
+    if (g_app.m_Culling)
+    {
+        const float hx = ((float) width) / 2.0f * g_app.m_Camera.Zoom();
+        const float hy = ((float) height) / 2.0f * g_app.m_Camera.Zoom();
+        rive::setCullRect(g_app.m_Renderer,
+            -hx - g_app.m_Camera.m_X, -hy - g_app.m_Camera.m_Y,
+             hx - g_app.m_Camera.m_X,  hy - g_app.m_Camera.m_Y);
+    }
+    else
+    {
+        rive::clearCullRect(g_app.m_Renderer);
+    }
+
+    g_app.m_DrawJobs.SetSize(0);
+    g_app.m_InstanceTransforms.SetSize(0);
 
     float y = 0.0f;
-    float x = 0.0f;
     for (int i = 0; i < App::MAX_ARTBOARD_CONTEXTS; ++i)
     {
         const App::ArtboardContext& ctx = g_app.m_ArtboardContexts[i];
         const int numArtboards          = (int)ctx.m_Artboards.Size();
 
-        for (int j = 0; j < numArtboards; ++j)
+        if (numArtboards == 0)
         {
-            renderer->save();
-            const App::ArtboardData& data            = ctx.m_Artboards[j];
-            rive::Artboard* artboard                 = data.m_Artboard;
-            rive::LinearAnimationInstance* animation = data.m_AnimationInstance;
-            rive::AABB artboardBounds                = artboard->bounds();
-            x = artboardBounds.width() * j;
+            continue;
+        }
+
+        const bool isInstanced = g_app.m_Instancing && numArtboards > 1 && IsCloneAnimationSynced(ctx);
+        const int numDrawn     = isInstanced ? 1 : numArtboards;
 
-            renderer->align(rive::Fit::none,
-               rive::Alignment::topLeft,
-               rive::AABB(x - width/2, y - height/2 , artboardBounds.width(), artboardBounds.height()),
-               artboardBounds);
+        const uint32_t instanceStart = g_app.m_InstanceTransforms.Size();
+        const rive::AABB bounds      = ctx.m_Artboards[0].m_Artboard->bounds();
 
-            if (animation)
+        // Clones whose animation is in step with the first one show the same pose, so only
+        // the first one is drawn. The rest are instances of it, offset by one artboard width each.
+        if (isInstanced)
+        {
+            if (g_app.m_InstanceTransforms.Capacity() < instanceStart + numArtboards)
             {
-                animation->advance(dt);
-                animation->apply(artboard, 1);
+                g_app.m_InstanceTransforms.SetCapacity(instanceStart + numArtboards);
             }
 
-            artboard->advance(dt);
-            artboard->draw(renderer);
-            renderer->restore();
-
-            if (j == (numArtboards-1))
+            for (int j = 0; j < numArtboards; ++j)
             {
-                y += artboardBounds.height();
+                rive::Mat2D instanceTransform;
+                instanceTransform[4] = bounds.width() * j;
+                g_app.m_InstanceTransforms.Push(instanceTransform);
             }
         }
+
+        if (g_app.m_DrawJobs.Capacity() < g_app.m_DrawJobs.Size() + numDrawn)
+        {
+            g_app.m_DrawJobs.SetCapacity(g_app.m_DrawJobs.Size() + numDrawn);
+        }
+
+        for (int j = 0; j < numDrawn; ++j)
+        {
+            const App::ArtboardData& data = ctx.m_Artboards[j];
+            App::DrawJob job = {
+                .m_Data          = &data,
+                .m_Renderer      = g_app.m_Renderer,
+                .m_Dt            = dt,
+                .m_X             = data.m_Artboard->bounds().width() * j - width/2,
+                .m_Y             = y - height/2,
+                .m_InstanceStart = instanceStart,
+                .m_InstanceCount = isInstanced ? (uint32_t) numArtboards : 0,
+            };
+            g_app.m_DrawJobs.Push(job);
+        }
+
+        y += ctx.m_Artboards[numDrawn-1].m_Artboard->bounds().height();
     }
+
+    const uint32_t numJobs = g_app.m_DrawJobs.Size();
+
+    // Artboards are independent, so they are advanced and recorded into one command
+    // list each on the thread pool, then appended in order to keep the output stable.
+    if (g_app.m_ThreadPool && numJobs > 1)
+    {
+        if (g_app.m_CommandLists.Capacity() < numJobs)
+        {
+            g_app.m_CommandLists.SetCapacity(numJobs);
+        }
+
+        while (g_app.m_CommandLists.Size() < numJobs)
+        {
+            g_app.m_CommandLists.Push(rive::createCommandList(g_app.m_Renderer));
+        }
+
+        for (uint32_t i = 0; i < numJobs; ++i)
+        {
+            g_app.m_DrawJobs[i].m_Renderer = g_app.m_CommandLists[i];
+        }
+
+        const rive::JobSystem jobSystem = rive::getJobSystem(g_app.m_ThreadPool);
+        jobSystem.m_SubmitCb(DrawArtboardJob, g_app.m_DrawJobs.Begin(), numJobs, jobSystem.m_UserData);
+        jobSystem.m_WaitCb(jobSystem.m_UserData);
+
+        for (uint32_t i = 0; i < numJobs; ++i)
+        {
+            rive::appendCommandList(g_app.m_Renderer, g_app.m_CommandLists[i]);
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0; i < numJobs; ++i)
+        {
+            DrawArtboard(g_app.m_DrawJobs[i]);
+        }
+    }
+
+    rive::endFrame(g_app.m_Renderer);
 }
 
-static void FillPaintData(rive::HRenderPaint paint, fs_paint_t& uniform)
+static void FillPaintData(const rive::PaintData& paintData, fs_paint_t& uniform)
 {
-    const rive::PaintData paintData = rive::getPaintData(paint);
-
     //  Note: Have to use vectors for the stops here aswell, doesn't work otherwise (sokol issue?)
     for (int i = 0; i < (int) paintData.m_StopCount; ++i)
     {
@@ -767,6 +1179,7 @@ static void FillPaintData(rive::HRenderPaint paint, fs_paint_t& uniform)
     uniform.gradientStop[1]  = paintData.m_GradientLimits[3];
 }
 
+#if !defined(RIVE_SOKOL_HEADLESS)
 // Adapted from https://github.com/floooh/sokol-samples/blob/master/glfw/imgui-glfw.cc
 static void AppDrawImgui(ImDrawData* drawData)
 {
@@ -827,6 +1240,7 @@ static void AppDrawImgui(ImDrawData* drawData)
         }
     }
 }
+#endif
 
 #define IS_BUFFER_VALID(b) (b != 0 && b->m_Handle.id != SG_INVALID_ID)
 
@@ -846,7 +1260,7 @@ static inline void GetCameraMatrix(mat4x4 M, uint32_t width, uint32_t height)
     mat4x4_mul(M, projection, view);
 }
 
-static void DebugViewContour(App::GpuBuffer* vxBuffer, App::GpuBuffer* ixBuffer, int numElements, vs_params_t& vsParams, fs_contour_t& fsParams)
+static void DebugViewContour(App::GpuBuffer* vxBuffer, App::GpuBuffer* ixBuffer, int numElements, int instanceCount, vs_params_t& vsParams, fs_contour_t& fsParams)
 {
     memcpy(fsParams.solidColor, g_app.m_DebugViewData.m_ContourSolidColor, sizeof(g_app.m_DebugViewData.m_ContourSolidColor));
     sg_pipeline& pipeline      = g_app.m_DebugViewContourPipeline;
@@ -859,9 +1273,301 @@ static void DebugViewContour(App::GpuBuffer* vxBuffer, App::GpuBuffer* ixBuffer,
     sg_apply_bindings(&bindings);
     sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &vsUniformsRange);
     sg_apply_uniforms(SG_SHADERSTAGE_FS, 0, &fsUniformsRange);
-    sg_draw(6, numElements, 1);
+    sg_draw(6, numElements, instanceCount);
+}
+
+// Walks the frame's draw events in whichever format the renderer recorded them
+template <typename T>
+static void DispatchDrawEvents(T& obj)
+{
+    if (rive::getRecordingFormat(g_app.m_Renderer) == rive::RECORDING_FORMAT_COMMANDS)
+    {
+        rive::DrawCommandIterator it = rive::beginDrawCommands(rive::getDrawCommands(g_app.m_Renderer));
+        while (rive::nextDrawCommand(it))
+        {
+            obj.HandleEvent(it.m_Event);
+        }
+        return;
+    }
+
+    const rive::DrawEventList events = rive::getDrawEvents(g_app.m_Renderer);
+    for (uint32_t i = 0; i < events.m_Count; ++i)
+    {
+        obj.HandleEvent(events.m_Events[i]);
+    }
 }
 
+// Pixel bounds of the quad [-1, 1] under the event's world transform, over all instances
+// that it is drawn with. The bounds are top left origin and not clamped to the viewport.
+static bool GetClipBounds(const rive::PathDrawEvent& evt, uint32_t instanceCount, uint32_t width, uint32_t height, float* bounds)
+{
+    mat4x4 transform;
+    GetPaletteTransform(evt.m_TransformWorldIdx, transform);
+    if (transform[0][0] == 0.0f && transform[0][1] == 0.0f &&
+        transform[1][0] == 0.0f && transform[1][1] == 0.0f)
+    {
+        return false;
+    }
+
+    mat4x4 camera;
+    GetCameraMatrix(camera, width, height);
+
+    const uint32_t instanceStart = g_app.m_Bindings.vertex_buffer_offsets[1] / sizeof(App::Instance);
+    float minX = FLT_MAX;
+    float minY = FLT_MAX;
+    float maxX = -FLT_MAX;
+    float maxY = -FLT_MAX;
+
+    for (uint32_t i = 0; i < instanceCount; ++i)
+    {
+        const App::Instance& instance = g_app.m_Instances[instanceStart + i];
+        for (int c = 0; c < 4; ++c)
+        {
+            vec4 corner = { (c == 1 || c == 2) ? 1.0f : -1.0f, c >= 2 ? 1.0f : -1.0f, 0.0f, 1.0f };
+            vec4 world, clip;
+            mat4x4_mul_vec4(world, transform, corner);
+
+            const float x = instance.m_Transform[0] * world[0] + instance.m_Transform[2] * world[1] + instance.m_Offset[0];
+            const float y = instance.m_Transform[1] * world[0] + instance.m_Transform[3] * world[1] + instance.m_Offset[1];
+            world[0] = x;
+            world[1] = y;
+
+            mat4x4_mul_vec4(clip, camera, world);
+            minX = fminf(minX, clip[0] / clip[3]);
+            minY = fminf(minY, clip[1] / clip[3]);
+            maxX = fmaxf(maxX, clip[0] / clip[3]);
+            maxY = fmaxf(maxY, clip[1] / clip[3]);
+        }
+    }
+
+    // Clip space y points up, the rect origin is top left
+    bounds[0] = (minX + 1.0f) * 0.5f * width;
+    bounds[1] = (1.0f - maxY) * 0.5f * height;
+    bounds[2] = (maxX + 1.0f) * 0.5f * width;
+    bounds[3] = (1.0f - minY) * 0.5f * height;
+    return true;
+}
+
+// Pixel rect of the clip bounds sent with EVENT_CLIPPING_BEGIN, rounded outwards
+static App::Rect GetClipRect(const rive::PathDrawEvent& evt, uint32_t instanceCount, uint32_t width, uint32_t height)
+{
+    App::Rect rect = {};
+    float bounds[4];
+    if (GetClipBounds(evt, instanceCount, width, height, bounds))
+    {
+        rect.m_X0 = (int) fmaxf(floorf(bounds[0]), 0.0f);
+        rect.m_Y0 = (int) fmaxf(floorf(bounds[1]), 0.0f);
+        rect.m_X1 = (int) fminf(ceilf(bounds[2]), (float) width);
+        rect.m_Y1 = (int) fminf(ceilf(bounds[3]), (float) height);
+    }
+    return rect;
+}
+
+// Pixel rect of the scissor sent with EVENT_CLIPPING_SCISSOR. It has to cover the same
+// pixels as a fill of the rect would, so the edges are rounded to the pixel centers.
+static App::Rect GetScissorRect(const rive::PathDrawEvent& evt, uint32_t instanceCount, uint32_t width, uint32_t height)
+{
+    App::Rect rect = { .m_X0 = 0, .m_Y0 = 0, .m_X1 = (int) width, .m_Y1 = (int) height };
+    if (!evt.m_IsClipping)
+    {
+        return rect;
+    }
+
+    float bounds[4];
+    if (!GetClipBounds(evt, instanceCount, width, height, bounds))
+    {
+        return {};
+    }
+
+    rect.m_X0 = (int) fmaxf(floorf(bounds[0] + 0.5f), 0.0f);
+    rect.m_Y0 = (int) fmaxf(floorf(bounds[1] + 0.5f), 0.0f);
+    rect.m_X1 = (int) fminf(floorf(bounds[2] + 0.5f), (float) width);
+    rect.m_Y1 = (int) fminf(floorf(bounds[3] + 0.5f), (float) height);
+    return rect;
+}
+
+static inline bool IsRectEmpty(const App::Rect& rect)
+{
+    return rect.m_X1 <= rect.m_X0 || rect.m_Y1 <= rect.m_Y0;
+}
+
+static App::Rect UnionRect(const App::Rect& a, const App::Rect& b)
+{
+    if (IsRectEmpty(a)) return b;
+    if (IsRectEmpty(b)) return a;
+    return {
+        .m_X0 = a.m_X0 < b.m_X0 ? a.m_X0 : b.m_X0,
+        .m_Y0 = a.m_Y0 < b.m_Y0 ? a.m_Y0 : b.m_Y0,
+        .m_X1 = a.m_X1 > b.m_X1 ? a.m_X1 : b.m_X1,
+        .m_Y1 = a.m_Y1 > b.m_Y1 ? a.m_Y1 : b.m_Y1,
+    };
+}
+
+static inline void ApplyScissorRect(const App::Rect& rect)
+{
+    if (IsRectEmpty(rect))
+    {
+        sg_apply_scissor_rect(0, 0, 0, 0, true);
+        return;
+    }
+    sg_apply_scissor_rect(rect.m_X0, rect.m_Y0, rect.m_X1 - rect.m_X0, rect.m_Y1 - rect.m_Y0, true);
+}
+
+// Zeroes the stencil buffer within rect, the scissor is left at rect
+static void ClearStencilRect(const App::Rect& rect)
+{
+    if (IsRectEmpty(rect))
+    {
+        return;
+    }
+
+    vs_params_t vsUniforms = {};
+    mat4x4_identity((float (*)[4]) vsUniforms.projection);
+    mat4x4_identity((float (*)[4]) vsUniforms.transform);
+    mat4x4_identity((float (*)[4]) vsUniforms.transformLocal);
+    sg_range vsUniformsRange = SG_RANGE(vsUniforms);
+
+    sg_bindings bindings              = g_app.m_Bindings;
+    bindings.vertex_buffers[0]        = g_app.m_StencilClearVertexBuffer;
+    bindings.vertex_buffer_offsets[0] = 0;
+    bindings.vertex_buffer_offsets[1] = 0;
+    bindings.index_buffer             = {};
+
+    ApplyScissorRect(rect);
+    sg_apply_pipeline(g_app.m_StencilClearPipeline);
+    sg_apply_bindings(&bindings);
+    sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &vsUniformsRange);
+    sg_draw(0, 4, 1);
+}
+
+// Clip space depth of the draw at position order out of count in painter's order,
+// later draws are nearer and no two draws share a depth.
+static inline float GetPainterDepth(uint32_t order, uint32_t count)
+{
+    return 1.0f - 2.0f * (float) (order + 1) / (float) (count + 1);
+}
+
+// Collects the opaque draws of the frame for the front to back pass, together with the
+// state they are drawn with. Draws within stencil clipping are left in painter's order,
+// the stencil they test is rewritten by the clips that follow them.
+struct AppOpaqueDrawCollector
+{
+    App::Rect m_ScissorRect;
+    uint32_t  m_PaintId;
+    uint32_t  m_InstanceCount;
+    uint32_t  m_TransformLocalIdx;
+    uint32_t  m_DrawCount;
+    uint32_t  m_Width              : 16;
+    uint32_t  m_Height             : 16;
+    uint32_t  m_IsApplyingClipping : 1;
+    uint32_t  m_IsClipping         : 1;
+
+    // Returns the number of draws in painter's order
+    static uint32_t Frame(uint32_t width, uint32_t height)
+    {
+        const int instanceOffset = g_app.m_Bindings.vertex_buffer_offsets[1];
+        g_app.m_OpaqueDraws.SetSize(0);
+
+        AppOpaqueDrawCollector obj(width, height);
+        DispatchDrawEvents(obj);
+
+        g_app.m_Bindings.vertex_buffer_offsets[1] = instanceOffset;
+        return obj.m_DrawCount;
+    }
+
+    AppOpaqueDrawCollector(uint32_t width, uint32_t height)
+    {
+        m_ScissorRect        = { .m_X0 = 0, .m_Y0 = 0, .m_X1 = (int) width, .m_Y1 = (int) height };
+        m_PaintId            = App::INVALID_PAINT_ID;
+        m_InstanceCount      = 1;
+        m_TransformLocalIdx  = 0;
+        m_DrawCount          = 0;
+        m_Width              = width;
+        m_Height             = height;
+        m_IsApplyingClipping = 0;
+        m_IsClipping         = 0;
+    }
+
+    void HandleEvent(const rive::PathDrawEvent& evt)
+    {
+        switch(evt.m_Type)
+        {
+            case rive::EVENT_SET_PAINT:
+                if (evt.m_Paint != 0)
+                {
+                    m_PaintId = evt.m_PaintId;
+                }
+                break;
+            case rive::EVENT_SET_INSTANCES:
+                m_InstanceCount = evt.m_OffsetEnd - evt.m_OffsetStart;
+                g_app.m_Bindings.vertex_buffer_offsets[1] = (1 + evt.m_OffsetStart) * sizeof(App::Instance);
+                break;
+            case rive::EVENT_DRAW:
+                if (!m_IsApplyingClipping)
+                {
+                    AddDraw(evt, IsPaintOpaque());
+                }
+                break;
+            case rive::EVENT_DRAW_STROKE:
+                AddDraw(evt, IsPaintOpaque());
+                m_TransformLocalIdx = evt.m_TransformLocalIdx;
+                break;
+            case rive::EVENT_DRAW_BATCH:
+                AddDraw(evt, rive::getBatchRange(g_app.m_Renderer, evt).m_IsOpaque);
+                break;
+            case rive::EVENT_CLIPPING_BEGIN:
+                m_IsApplyingClipping = true;
+                m_IsClipping         = true;
+                break;
+            case rive::EVENT_CLIPPING_END:
+                m_IsApplyingClipping = false;
+                break;
+            case rive::EVENT_CLIPPING_DISABLE:
+                m_IsClipping = false;
+                break;
+            case rive::EVENT_CLIPPING_SCISSOR:
+                m_ScissorRect = GetScissorRect(evt, m_InstanceCount, m_Width, m_Height);
+                break;
+            default:break;
+        }
+    }
+
+    bool IsPaintOpaque()
+    {
+        return m_PaintId != App::INVALID_PAINT_ID && rive::getPaintData(g_app.m_Renderer, m_PaintId)->m_IsOpaque;
+    }
+
+    // Fills are drawn with the local transform of the last stroke, it is kept with the event
+    void AddDraw(const rive::PathDrawEvent& evt, bool isOpaque)
+    {
+        const uint32_t order = m_DrawCount++;
+        if (!isOpaque || m_IsClipping)
+        {
+            return;
+        }
+
+        App::OpaqueDraw draw = {
+            .m_Event          = evt,
+            .m_ScissorRect    = m_ScissorRect,
+            .m_PaintId        = m_PaintId,
+            .m_InstanceOffset = (uint32_t) g_app.m_Bindings.vertex_buffer_offsets[1],
+            .m_InstanceCount  = m_InstanceCount,
+            .m_Order          = order,
+        };
+
+        if (evt.m_Type == rive::EVENT_DRAW)
+        {
+            draw.m_Event.m_TransformLocalIdx = m_TransformLocalIdx;
+        }
+
+        if (g_app.m_OpaqueDraws.Full())
+        {
+            g_app.m_OpaqueDraws.SetCapacity(g_app.m_OpaqueDraws.Capacity() + 256);
+        }
+        g_app.m_OpaqueDraws.Push(draw);
+    }
+};
+
 struct AppTessellationRenderer
 {
     vs_params_t        m_VsUniforms;
@@ -869,42 +1575,72 @@ struct AppTessellationRenderer
     sg_range           m_VsUniformsRange;
     sg_range           m_FsUniformsRange;
     rive::HRenderPaint m_Paint;
+    uint32_t           m_PaintId;
+    uint32_t           m_InstanceCount;
+    uint32_t           m_DrawOrder;
+    uint32_t           m_DrawCount;
+    uint32_t           m_OpaqueIndex;
+    App::Rect          m_ScissorRect;
     uint32_t           m_Width              : 16;
     uint32_t           m_Height             : 16;
     uint32_t           m_AppliedClipCount   : 8;
+    uint32_t           m_ClipLevel          : 8;
+    uint32_t           m_ClipPopLevel       : 8;
     uint32_t           m_PaintDirty         : 1;
     uint32_t           m_IsApplyingClipping : 1;
     uint32_t           m_IsClipping         : 1;
+    uint32_t           m_IsDepthSorted      : 1;
+    uint32_t           m_IsOpaquePass       : 1;
 
+    // With the opaque pass, the opaque draws are drawn first front to back with depth
+    // writes. The remaining draws follow in painter's order at their painter depth, so
+    // whatever an opaque draw in front of them covers is rejected by the depth test.
     static void Frame(uint32_t width, uint32_t height)
     {
         AppTessellationRenderer obj(width, height);
-        for (int i = 0; i < (int) rive::getDrawEventCount(g_app.m_Renderer); ++i)
+        if (g_app.m_OpaquePass && g_app.m_DebugView == App::DEBUG_VIEW_NONE)
         {
-            const rive::PathDrawEvent evt = rive::getDrawEvent(g_app.m_Renderer, i);
-            switch(evt.m_Type)
-            {
-                case rive::EVENT_SET_PAINT:
-                    obj.SetPaint(evt);
-                    break;
-                case rive::EVENT_DRAW:
-                    if (g_app.m_DebugView != App::DEBUG_VIEW_NONE)
-                         obj.HandleDebugViews(evt);
-                    else obj.DrawPass(evt);
-                    break;
-                case rive::EVENT_DRAW_STROKE:
-                    obj.DrawStroke(evt);
-                    break;
-                case rive::EVENT_CLIPPING_BEGIN:
-                    obj.BeginClipping(evt);
-                    break;
-                case rive::EVENT_CLIPPING_END:
-                    obj.EndClipping(evt);
-                    break;
-                case rive::EVENT_CLIPPING_DISABLE:
-                    obj.CancelClipping(evt);
-                default:break;
-            }
+            obj.m_DrawCount     = AppOpaqueDrawCollector::Frame(width, height);
+            obj.m_IsDepthSorted = true;
+            obj.DrawOpaquePass();
+        }
+        DispatchDrawEvents(obj);
+    }
+
+    void HandleEvent(const rive::PathDrawEvent& evt)
+    {
+        switch(evt.m_Type)
+        {
+            case rive::EVENT_SET_PAINT:
+                SetPaint(evt);
+                break;
+            case rive::EVENT_SET_INSTANCES:
+                SetInstances(evt);
+                break;
+            case rive::EVENT_DRAW:
+                if (g_app.m_DebugView != App::DEBUG_VIEW_NONE)
+                     HandleDebugViews(evt);
+                else DrawPass(evt);
+                break;
+            case rive::EVENT_DRAW_STROKE:
+                DrawStroke(evt);
+                break;
+            case rive::EVENT_DRAW_BATCH:
+                DrawBatch(evt);
+                break;
+            case rive::EVENT_CLIPPING_BEGIN:
+                BeginClipping(evt);
+                break;
+            case rive::EVENT_CLIPPING_END:
+                EndClipping(evt);
+                break;
+            case rive::EVENT_CLIPPING_DISABLE:
+                CancelClipping(evt);
+                break;
+            case rive::EVENT_CLIPPING_SCISSOR:
+                SetScissor(evt);
+                break;
+            default:break;
         }
     }
 
@@ -913,14 +1649,25 @@ struct AppTessellationRenderer
         m_VsUniforms      = {};
         m_FsUniforms      = {};
         m_Paint           = 0;
+        m_PaintId         = App::INVALID_PAINT_ID;
+        m_InstanceCount   = 1;
         m_VsUniformsRange = SG_RANGE(m_VsUniforms);
         m_FsUniformsRange = SG_RANGE(m_FsUniforms);
         m_Width           = width;
         m_Height          = height;
+        m_ScissorRect     = { .m_X0 = 0, .m_Y0 = 0, .m_X1 = (int) width, .m_Y1 = (int) height };
 
+        m_AppliedClipCount   = 0;
+        m_ClipLevel          = 0;
+        m_ClipPopLevel       = 0;
         m_IsApplyingClipping = 0;
         m_IsClipping         = 0;
         m_PaintDirty         = 0;
+        m_IsDepthSorted      = 0;
+        m_IsOpaquePass       = 0;
+        m_DrawOrder          = 0;
+        m_DrawCount          = 0;
+        m_OpaqueIndex        = 0;
 
         mat4x4 mtxCam;
         GetCameraMatrix(mtxCam, width, height);
@@ -929,40 +1676,117 @@ struct AppTessellationRenderer
         sg_apply_viewport(0, 0, width, height, true);
     }
 
+    // Opaque draws in reverse painter's order, each at its painter depth. The projection
+    // z translation is the clip space depth of every vertex, since the transforms are 2D.
+    void DrawOpaquePass()
+    {
+        const int instanceOffset = g_app.m_Bindings.vertex_buffer_offsets[1];
+        m_IsOpaquePass = true;
+
+        for (int i = (int) g_app.m_OpaqueDraws.Size() - 1; i >= 0; --i)
+        {
+            const App::OpaqueDraw& draw = g_app.m_OpaqueDraws[i];
+
+            if (m_PaintId != draw.m_PaintId)
+            {
+                m_PaintId    = draw.m_PaintId;
+                m_PaintDirty = true;
+            }
+
+            m_InstanceCount = draw.m_InstanceCount;
+            g_app.m_Bindings.vertex_buffer_offsets[1] = draw.m_InstanceOffset;
+            m_VsUniforms.projection[14] = GetPainterDepth(draw.m_Order, m_DrawCount);
+            ApplyScissorRect(draw.m_ScissorRect);
+
+            switch(draw.m_Event.m_Type)
+            {
+                case rive::EVENT_DRAW:
+                    GetPaletteTransform(draw.m_Event.m_TransformLocalIdx, (float (*)[4]) m_VsUniforms.transformLocal);
+                    DrawPass(draw.m_Event);
+                    break;
+                case rive::EVENT_DRAW_STROKE:
+                    DrawStroke(draw.m_Event);
+                    break;
+                case rive::EVENT_DRAW_BATCH:
+                    DrawBatch(draw.m_Event);
+                    break;
+                default:break;
+            }
+        }
+
+        m_IsOpaquePass  = false;
+        m_InstanceCount = 1;
+        g_app.m_Bindings.vertex_buffer_offsets[1] = instanceOffset;
+        mat4x4_identity((float (*)[4]) m_VsUniforms.transformLocal);
+        ApplyScissorRect(m_ScissorRect);
+    }
+
+    // Advances painter's order, returns false for draws already done in the opaque pass
+    bool NextPainterDraw()
+    {
+        if (!m_IsDepthSorted || m_IsOpaquePass)
+        {
+            return true;
+        }
+
+        const uint32_t order = m_DrawOrder++;
+        if (m_OpaqueIndex < g_app.m_OpaqueDraws.Size() && g_app.m_OpaqueDraws[m_OpaqueIndex].m_Order == order)
+        {
+            m_OpaqueIndex++;
+            return false;
+        }
+
+        m_VsUniforms.projection[14] = GetPainterDepth(order, m_DrawCount);
+        return true;
+    }
+
+    void SetInstances(const rive::PathDrawEvent& evt)
+    {
+        m_InstanceCount = evt.m_OffsetEnd - evt.m_OffsetStart;
+        g_app.m_Bindings.vertex_buffer_offsets[1] = (1 + evt.m_OffsetStart) * sizeof(App::Instance);
+    }
+
     void SetPaint(const rive::PathDrawEvent& evt)
     {
-        if (evt.m_Paint != 0 && m_Paint != evt.m_Paint)
+        if (evt.m_Paint == 0)
+        {
+            return;
+        }
+
+        // Identical paints share an id, only upload when the content changes
+        m_Paint = evt.m_Paint;
+        if (m_PaintId != evt.m_PaintId)
         {
-            m_Paint      = evt.m_Paint;
+            m_PaintId    = evt.m_PaintId;
             m_PaintDirty = true;
         }
     }
 
+    // The stencil holds the clip level, each clip draw pops or pushes one level where
+    // the stencil is at the current one. Starting from level zero, only the stencil
+    // written by the last clip paths is cleared and the new clip paths are drawn
+    // scissored to their bounds. Otherwise all levels are within the last clip rect.
     void BeginClipping(const rive::PathDrawEvent& evt)
     {
-        m_IsApplyingClipping  = true;
-        m_IsClipping          = true;
-        sg_pass_action action = {};
-        action.colors[0]      = { .action = SG_ACTION_DONTCARE };
-        action.depth          = { .action = SG_ACTION_DONTCARE };
-        action.stencil        = { .action = SG_ACTION_CLEAR    };
+        m_IsApplyingClipping = true;
+        m_IsClipping         = true;
+        m_ClipLevel          = evt.m_AppliedClipCount;
+        m_ClipPopLevel       = evt.m_Idx;
 
-        sg_end_pass();
-        sg_begin_default_pass(&action, m_Width, m_Height);
+        if (m_ClipLevel == 0)
+        {
+            const App::Rect clipRect = GetClipRect(evt, m_InstanceCount, m_Width, m_Height);
+            ClearStencilRect(UnionRect(g_app.m_StencilRect, clipRect));
+            g_app.m_StencilRect = clipRect;
+        }
+        ApplyScissorRect(g_app.m_StencilRect);
     }
 
     void EndClipping(const rive::PathDrawEvent& evt)
     {
-        m_IsApplyingClipping  = false;
-        m_AppliedClipCount    = evt.m_AppliedClipCount;
-
-        sg_pass_action action = {};
-        action.colors[0]      = { .action = SG_ACTION_DONTCARE };
-        action.depth          = { .action = SG_ACTION_DONTCARE };
-        action.stencil        = { .action = SG_ACTION_DONTCARE };
-
-        sg_end_pass();
-        sg_begin_default_pass(&action, m_Width, m_Height);
+        m_IsApplyingClipping = false;
+        m_AppliedClipCount   = evt.m_AppliedClipCount;
+        ApplyScissorRect(m_ScissorRect);
     }
 
     void CancelClipping(const rive::PathDrawEvent& evt)
@@ -970,18 +1794,35 @@ struct AppTessellationRenderer
         m_IsClipping = false;
     }
 
-    sg_pipeline GetIsClippingPipeline(uint8_t v)
+    // Rect clips, the stencil clipping is tested on top of it
+    void SetScissor(const rive::PathDrawEvent& evt)
     {
-        sg_pipeline* p = &g_app.m_TessellationIsClippingPipelines[v];
+        m_ScissorRect = GetScissorRect(evt, m_InstanceCount, m_Width, m_Height);
+        ApplyScissorRect(m_ScissorRect);
+    }
+
+    sg_pipeline GetIsClippingPipeline(uint8_t v, bool batched = false)
+    {
+        sg_pipeline* p = batched ? &g_app.m_BatchIsClippingPipelines[v] : &g_app.m_TessellationIsClippingPipelines[v];
         if (p->id == SG_INVALID_ID)
         {
             sg_pipeline_desc pDesc               = {};
-            pDesc.shader                         = g_app.m_MainShader;
+            pDesc.shader                         = batched ? g_app.m_BatchShader : g_app.m_MainShader;
             pDesc.index_type                     = SG_INDEXTYPE_UINT32;
             pDesc.layout.attrs[0]                = { .format = SG_VERTEXFORMAT_FLOAT2 };
+            if (batched)
+            {
+                pDesc.layout.attrs[1]            = { .format = SG_VERTEXFORMAT_UBYTE4N };
+                SetInstanceLayout(pDesc, ATTR_vs_batch_instanceTransform, ATTR_vs_batch_instanceOffset);
+            }
+            else
+            {
+                SetInstanceLayout(pDesc, ATTR_vs_instanceTransform, ATTR_vs_instanceOffset);
+            }
             pDesc.colors[0].blend.enabled        = true;
             pDesc.colors[0].blend.src_factor_rgb = SG_BLENDFACTOR_SRC_ALPHA;
             pDesc.colors[0].blend.dst_factor_rgb = SG_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
+            pDesc.depth.compare                  = SG_COMPAREFUNC_LESS_EQUAL;
 
             pDesc.stencil.enabled                = true;
             pDesc.stencil.front.compare          = SG_COMPAREFUNC_EQUAL;
@@ -1003,8 +1844,47 @@ struct AppTessellationRenderer
         return *p;
     }
 
+    // Increments or decrements the stencil where it is at clip level v
+    sg_pipeline GetClipLevelPipeline(uint8_t v, bool pop)
+    {
+        sg_pipeline* p = pop ? &g_app.m_TessellationClipPopPipelines[v] : &g_app.m_TessellationClipPushPipelines[v];
+        if (p->id == SG_INVALID_ID)
+        {
+            const sg_stencil_op op = pop ? SG_STENCILOP_DECR_CLAMP : SG_STENCILOP_INCR_CLAMP;
+
+            sg_pipeline_desc pDesc            = {};
+            pDesc.shader                      = g_app.m_MainShader;
+            pDesc.index_type                  = SG_INDEXTYPE_UINT32;
+            pDesc.layout.attrs[0]             = { .format = SG_VERTEXFORMAT_FLOAT2 };
+            SetInstanceLayout(pDesc, ATTR_vs_instanceTransform, ATTR_vs_instanceOffset);
+
+            pDesc.stencil.enabled             = true;
+            pDesc.stencil.front.compare       = SG_COMPAREFUNC_EQUAL;
+            pDesc.stencil.front.fail_op       = SG_STENCILOP_KEEP;
+            pDesc.stencil.front.depth_fail_op = SG_STENCILOP_KEEP;
+            pDesc.stencil.front.pass_op       = op;
+            pDesc.stencil.back.compare        = SG_COMPAREFUNC_EQUAL;
+            pDesc.stencil.back.fail_op        = SG_STENCILOP_KEEP;
+            pDesc.stencil.back.depth_fail_op  = SG_STENCILOP_KEEP;
+            pDesc.stencil.back.pass_op        = op;
+            pDesc.stencil.ref                 = v;
+            pDesc.stencil.write_mask          = 0xFF;
+            pDesc.stencil.read_mask           = 0xFF;
+            pDesc.colors[0].write_mask        = SG_COLORMASK_NONE;
+
+            *p = sg_make_pipeline(&pDesc);
+        }
+
+        return *p;
+    }
+
     void DrawPass(const rive::PathDrawEvent& evt)
     {
+        if (!m_IsApplyingClipping && !NextPainterDraw())
+        {
+            return;
+        }
+
         const rive::DrawBuffers buffers = rive::getDrawBuffers(g_app.m_Ctx, g_app.m_Renderer, evt.m_Path);
         App::GpuBuffer* vertexBuffer    = (App::GpuBuffer*) buffers.m_VertexBuffer;
         App::GpuBuffer* indexBuffer     = (App::GpuBuffer*) buffers.m_IndexBuffer;
@@ -1014,18 +1894,25 @@ struct AppTessellationRenderer
             return;
         }
 
-        Mat2DToMat4(evt.m_TransformWorld, (float (*)[4]) m_VsUniforms.transform);
+        GetPaletteTransform(evt.m_TransformWorldIdx, (float (*)[4]) m_VsUniforms.transform);
         int drawLength = (indexBuffer->m_DataSize / sizeof(int)) * 3;
 
         sg_bindings& bindings      = g_app.m_Bindings;
         bindings.vertex_buffers[0] = vertexBuffer->m_Handle;
         bindings.index_buffer      = indexBuffer->m_Handle;
 
-        sg_pipeline pipeline = g_app.m_TessellationPipeline;
+        sg_pipeline pipeline = m_IsOpaquePass ? g_app.m_TessellationOpaquePipeline : g_app.m_TessellationPipeline;
 
         if (m_IsApplyingClipping)
         {
-            pipeline = g_app.m_TessellationApplyClippingPipeline;
+            if (m_ClipLevel > m_ClipPopLevel)
+            {
+                pipeline = GetClipLevelPipeline(m_ClipLevel--, true);
+            }
+            else
+            {
+                pipeline = GetClipLevelPipeline(m_ClipLevel++, false);
+            }
         }
         else if (m_IsClipping)
         {
@@ -1038,17 +1925,23 @@ struct AppTessellationRenderer
 
         if (m_PaintDirty && !m_IsApplyingClipping)
         {
-            FillPaintData(m_Paint, m_FsUniforms);
+            FillPaintData(*rive::getPaintData(g_app.m_Renderer, m_PaintId), m_FsUniforms);
             sg_apply_uniforms(SG_SHADERSTAGE_FS, SLOT_fs_paint, &m_FsUniformsRange);
             m_PaintDirty = false;
         }
 
-        sg_draw(0, drawLength, 1);
+        sg_draw(0, drawLength, m_InstanceCount);
     }
 
     void DrawStroke(const rive::PathDrawEvent& evt)
     {
-        const rive::DrawBuffers buffers = rive::getDrawBuffers(g_app.m_Ctx, g_app.m_Renderer, m_Paint);
+        if (!NextPainterDraw())
+        {
+            GetPaletteTransform(evt.m_TransformLocalIdx, (float (*)[4]) m_VsUniforms.transformLocal);
+            return;
+        }
+
+        const rive::DrawBuffers buffers = rive::getStrokeDrawBuffers(g_app.m_Renderer, evt);
         App::GpuBuffer* strokebuffer    = (App::GpuBuffer*) buffers.m_VertexBuffer;
         if (!IS_BUFFER_VALID(strokebuffer))
         {
@@ -1059,21 +1952,57 @@ struct AppTessellationRenderer
         bindings.vertex_buffers[0] = strokebuffer->m_Handle;
         bindings.index_buffer      = {};
 
-        rive::Mat2D transformWorld  = evt.m_TransformWorld;
-        rive::Mat2D transformLocal  = evt.m_TransformLocal;
-        Mat2DToMat4(transformWorld, (float (*)[4]) m_VsUniforms.transform);
-        Mat2DToMat4(transformLocal, (float (*)[4]) m_VsUniforms.transformLocal);
+        GetPaletteTransform(evt.m_TransformWorldIdx, (float (*)[4]) m_VsUniforms.transform);
+        GetPaletteTransform(evt.m_TransformLocalIdx, (float (*)[4]) m_VsUniforms.transformLocal);
 
-        sg_apply_pipeline(g_app.m_StrokePipeline);
+        sg_apply_pipeline(m_IsOpaquePass ? g_app.m_StrokeOpaquePipeline : g_app.m_StrokePipeline);
         sg_apply_bindings(&bindings);
         sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &m_VsUniformsRange);
         if (!m_IsApplyingClipping && m_PaintDirty)
         {
-            FillPaintData(m_Paint, m_FsUniforms);
+            FillPaintData(*rive::getPaintData(g_app.m_Renderer, m_PaintId), m_FsUniforms);
             sg_apply_uniforms(SG_SHADERSTAGE_FS, SLOT_fs_paint, &m_FsUniformsRange);
             m_PaintDirty = false;
         }
-        sg_draw(evt.m_OffsetStart, evt.m_OffsetEnd - evt.m_OffsetStart, 1);
+        sg_draw(evt.m_OffsetStart, evt.m_OffsetEnd - evt.m_OffsetStart, m_InstanceCount);
+    }
+
+    void DrawBatch(const rive::PathDrawEvent& evt)
+    {
+        if (!NextPainterDraw())
+        {
+            return;
+        }
+
+        const rive::DrawBuffers buffers = rive::getBatchDrawBuffers(g_app.m_Renderer);
+        App::GpuBuffer* vertexBuffer    = (App::GpuBuffer*) buffers.m_VertexBuffer;
+        App::GpuBuffer* indexBuffer     = (App::GpuBuffer*) buffers.m_IndexBuffer;
+
+        if (!IS_BUFFER_VALID(vertexBuffer) || !IS_BUFFER_VALID(indexBuffer))
+        {
+            return;
+        }
+
+        sg_bindings& bindings      = g_app.m_Bindings;
+        bindings.vertex_buffers[0] = vertexBuffer->m_Handle;
+        bindings.index_buffer      = indexBuffer->m_Handle;
+
+        // Batched vertices are already in world space
+        vs_batch_params_t vsBatchUniforms;
+        memcpy(vsBatchUniforms.projection, m_VsUniforms.projection, sizeof(vsBatchUniforms.projection));
+
+        sg_pipeline pipeline = m_IsOpaquePass ? g_app.m_BatchOpaquePipeline : g_app.m_BatchPipeline;
+        if (m_IsClipping)
+        {
+            pipeline = GetIsClippingPipeline(m_AppliedClipCount, true);
+        }
+
+        sg_apply_pipeline(pipeline);
+        sg_apply_bindings(&bindings);
+        sg_apply_uniforms(SG_SHADERSTAGE_VS, SLOT_vs_batch_params, SG_RANGE(vsBatchUniforms));
+
+        const rive::BatchRange range = rive::getBatchRange(g_app.m_Renderer, evt);
+        sg_draw(range.m_IndexStart, range.m_IndexCount, m_InstanceCount);
     }
 
     void HandleDebugViews(const rive::PathDrawEvent& evt)
@@ -1088,15 +2017,16 @@ struct AppTessellationRenderer
             return;
         }
 
-        const rive::PaintData paintData = getPaintData(m_Paint);
+        const rive::PaintData* paintData = rive::getPaintData(g_app.m_Renderer, m_PaintId);
 
         fs_contour_t fsContourParams                = {};
-        memcpy(fsContourParams.color, paintData.m_Colors, sizeof(float) * 4);
-        Mat2DToMat4(evt.m_TransformWorld, (float (*)[4]) m_VsUniforms.transform);
+        memcpy(fsContourParams.color, paintData->m_Colors, sizeof(float) * 4);
+        GetPaletteTransform(evt.m_TransformWorldIdx, (float (*)[4]) m_VsUniforms.transform);
         DebugViewContour(
             vertexBuffer,
             indexBuffer,
             (indexBuffer->m_DataSize / sizeof(int)) * 3,
+            m_InstanceCount,
             m_VsUniforms,
             fsContourParams);
     }
@@ -1109,7 +2039,10 @@ struct AppSTCRenderer
     sg_range           m_VsUniformsRange;
     sg_range           m_FsUniformsRange;
     rive::HRenderPaint m_Paint;
+    uint32_t           m_PaintId;
+    uint32_t           m_InstanceCount;
     mat4x4             m_CameraMtx;
+    App::Rect          m_ScissorRect;
     uint32_t           m_Width              : 16;
     uint32_t           m_Height             : 16;
     uint8_t            m_PaintDirty         : 1;
@@ -1118,34 +2051,41 @@ struct AppSTCRenderer
     static void Frame(uint32_t width, uint32_t height)
     {
         AppSTCRenderer obj(width, height);
-        for (int i = 0; i < (int) rive::getDrawEventCount(g_app.m_Renderer); ++i)
+        DispatchDrawEvents(obj);
+    }
+
+    void HandleEvent(const rive::PathDrawEvent& evt)
+    {
+        switch(evt.m_Type)
         {
-            const rive::PathDrawEvent evt = rive::getDrawEvent(g_app.m_Renderer, i);
-            switch(evt.m_Type)
-            {
-                case rive::EVENT_SET_PAINT:
-                    obj.SetPaint(evt);
-                    break;
-                case rive::EVENT_DRAW_STENCIL:
-                    if (g_app.m_DebugView != App::DEBUG_VIEW_NONE)
-                         obj.HandleDebugViews(evt);
-                    else obj.StencilPass(evt);
-                    break;
-                case rive::EVENT_DRAW_COVER:
-                    if (g_app.m_DebugView == App::DEBUG_VIEW_NONE)
-                        obj.CoverPass(evt);
-                    break;
-                case rive::EVENT_DRAW_STROKE:
-                    obj.DrawStroke(evt);
-                    break;
-                case rive::EVENT_CLIPPING_BEGIN:
-                    obj.BeginClipping(evt);
-                    break;
-                case rive::EVENT_CLIPPING_END:
-                    obj.EndClipping(evt);
-                    break;
-                default:break;
-            }
+            case rive::EVENT_SET_PAINT:
+                SetPaint(evt);
+                break;
+            case rive::EVENT_SET_INSTANCES:
+                SetInstances(evt);
+                break;
+            case rive::EVENT_DRAW_STENCIL:
+                if (g_app.m_DebugView != App::DEBUG_VIEW_NONE)
+                     HandleDebugViews(evt);
+                else StencilPass(evt);
+                break;
+            case rive::EVENT_DRAW_COVER:
+                if (g_app.m_DebugView == App::DEBUG_VIEW_NONE)
+                    CoverPass(evt);
+                break;
+            case rive::EVENT_DRAW_STROKE:
+                DrawStroke(evt);
+                break;
+            case rive::EVENT_CLIPPING_BEGIN:
+                BeginClipping(evt);
+                break;
+            case rive::EVENT_CLIPPING_END:
+                EndClipping(evt);
+                break;
+            case rive::EVENT_CLIPPING_SCISSOR:
+                SetScissor(evt);
+                break;
+            default:break;
         }
     }
 
@@ -1154,11 +2094,14 @@ struct AppSTCRenderer
         m_VsUniforms      = {};
         m_FsUniforms      = {};
         m_Paint           = 0;
+        m_PaintId         = App::INVALID_PAINT_ID;
+        m_InstanceCount   = 1;
         m_PaintDirty      = false;
         m_VsUniformsRange = SG_RANGE(m_VsUniforms);
         m_FsUniformsRange = SG_RANGE(m_FsUniforms);
         m_Width           = width;
         m_Height          = height;
+        m_ScissorRect     = { .m_X0 = 0, .m_Y0 = 0, .m_X1 = (int) width, .m_Y1 = (int) height };
 
         mat4x4 mtxCam;
         GetCameraMatrix(mtxCam, width, height);
@@ -1169,37 +2112,57 @@ struct AppSTCRenderer
         sg_apply_viewport(0, 0, width, height, true);
     }
 
+    void SetInstances(const rive::PathDrawEvent& evt)
+    {
+        m_InstanceCount = evt.m_OffsetEnd - evt.m_OffsetStart;
+        g_app.m_Bindings.vertex_buffer_offsets[1] = (1 + evt.m_OffsetStart) * sizeof(App::Instance);
+    }
+
     void SetPaint(const rive::PathDrawEvent& evt)
     {
-        if (evt.m_Paint != 0 && m_Paint != evt.m_Paint)
+        if (evt.m_Paint == 0)
+        {
+            return;
+        }
+
+        // Identical paints share an id, only upload when the content changes
+        m_Paint = evt.m_Paint;
+        if (m_PaintId != evt.m_PaintId)
         {
-            m_Paint      = evt.m_Paint;
+            m_PaintId    = evt.m_PaintId;
             m_PaintDirty = true;
         }
     }
 
+    // Fills reset the stencil under their cover, so only the clip bits of the last
+    // clip paths are left to clear. The fullscreen covers that intersect the clip
+    // paths are scissored to the clip bounds, outside of them the clip bits are zero.
+    // Clip paths pushed on top of the applied ones keep the stencil, their clip bits
+    // are all within the last clip rect.
     void BeginClipping(const rive::PathDrawEvent& evt)
     {
-        m_IsApplyingClipping  = true;
-        sg_pass_action action = {};
-        action.colors[0]      = { .action = SG_ACTION_DONTCARE };
-        action.depth          = { .action = SG_ACTION_DONTCARE };
-        action.stencil        = { .action = SG_ACTION_CLEAR, .value = 0x00 };
+        m_IsApplyingClipping = true;
 
-        sg_end_pass();
-        sg_begin_default_pass(&action, m_Width, m_Height);
+        if (evt.m_AppliedClipCount == 0)
+        {
+            const App::Rect clipRect = GetClipRect(evt, m_InstanceCount, m_Width, m_Height);
+            ClearStencilRect(UnionRect(g_app.m_StencilRect, clipRect));
+            g_app.m_StencilRect = clipRect;
+        }
+        ApplyScissorRect(g_app.m_StencilRect);
     }
 
     void EndClipping(const rive::PathDrawEvent& evt)
     {
-        m_IsApplyingClipping  = false;
-        sg_pass_action action = {};
-        action.colors[0]      = { .action = SG_ACTION_DONTCARE };
-        action.depth          = { .action = SG_ACTION_DONTCARE };
-        action.stencil        = { .action = SG_ACTION_DONTCARE };
+        m_IsApplyingClipping = false;
+        ApplyScissorRect(m_ScissorRect);
+    }
 
-        sg_end_pass();
-        sg_begin_default_pass(&action, m_Width, m_Height);
+    // Rect clips, the stencil clipping is tested on top of it
+    void SetScissor(const rive::PathDrawEvent& evt)
+    {
+        m_ScissorRect = GetScissorRect(evt, m_InstanceCount, m_Width, m_Height);
+        ApplyScissorRect(m_ScissorRect);
     }
 
     void StencilPass(const rive::PathDrawEvent& evt)
@@ -1249,12 +2212,11 @@ struct AppSTCRenderer
         if (vertexCount < 5)
             return;
 
-        rive::Mat2D transformWorld  = evt.m_TransformWorld;
-        Mat2DToMat4(transformWorld, (float (*)[4]) m_VsUniforms.transform);
+        GetPaletteTransform(evt.m_TransformWorldIdx, (float (*)[4]) m_VsUniforms.transform);
         sg_apply_pipeline(pipeline);
         sg_apply_bindings(&bindings);
         sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &m_VsUniformsRange);
-        sg_draw(6, triangleCount * 3, 1);
+        sg_draw(6, triangleCount * 3, m_InstanceCount);
     }
 
     void CoverPass(const rive::PathDrawEvent& evt)
@@ -1273,22 +2235,25 @@ struct AppSTCRenderer
         bindings.vertex_buffers[0] = coverVertexBuffer->m_Handle;
         bindings.index_buffer      = coverIndexBuffer->m_Handle;
 
-        rive::Mat2D transformWorld  = evt.m_TransformWorld;
-        rive::Mat2D transformLocal  = evt.m_TransformLocal;
-        Mat2DToMat4(transformWorld, (float (*)[4]) m_VsUniforms.transform);
-        Mat2DToMat4(transformLocal, (float (*)[4]) m_VsUniforms.transformLocal);
+        GetPaletteTransform(evt.m_TransformWorldIdx, (float (*)[4]) m_VsUniforms.transform);
+        GetPaletteTransform(evt.m_TransformLocalIdx, (float (*)[4]) m_VsUniforms.transformLocal);
 
         sg_pipeline pipeline = {};
-        bool restoreCamera = false;
+        bool restoreCamera   = false;
+        int instanceCount    = m_InstanceCount;
+        int instanceOffset   = g_app.m_Bindings.vertex_buffer_offsets[1];
 
         if (m_IsApplyingClipping)
         {
             pipeline = g_app.m_StencilPipelineCoverIsApplyingCLipping;
 
+            // The fullscreen quad is already in clip space, draw it once with the identity instance
             if (evt.m_IsClipping)
             {
                 mat4x4_identity((float (*)[4]) m_VsUniforms.projection);
                 mat4x4_identity((float (*)[4]) m_VsUniforms.transform);
+                bindings.vertex_buffer_offsets[1] = 0;
+                instanceCount = 1;
                 restoreCamera = true;
             }
         }
@@ -1309,21 +2274,22 @@ struct AppSTCRenderer
         sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &m_VsUniformsRange);
         if (!m_IsApplyingClipping && m_PaintDirty)
         {
-            FillPaintData(m_Paint, m_FsUniforms);
+            FillPaintData(*rive::getPaintData(g_app.m_Renderer, m_PaintId), m_FsUniforms);
             sg_apply_uniforms(SG_SHADERSTAGE_FS, SLOT_fs_paint, &m_FsUniformsRange);
             m_PaintDirty = false;
         }
-        sg_draw(0, 2 * 3, 1);
+        sg_draw(0, 2 * 3, instanceCount);
 
         if (restoreCamera)
         {
             mat4x4_dup((float (*)[4]) m_VsUniforms.projection, m_CameraMtx);
+            bindings.vertex_buffer_offsets[1] = instanceOffset;
         }
     }
 
     void DrawStroke(const rive::PathDrawEvent& evt)
     {
-        const rive::DrawBuffers buffers = rive::getDrawBuffers(g_app.m_Ctx, g_app.m_Renderer, m_Paint);
+        const rive::DrawBuffers buffers = rive::getStrokeDrawBuffers(g_app.m_Renderer, evt);
         App::GpuBuffer* strokebuffer    = (App::GpuBuffer*) buffers.m_VertexBuffer;
         if (!IS_BUFFER_VALID(strokebuffer))
         {
@@ -1334,21 +2300,19 @@ struct AppSTCRenderer
         bindings.vertex_buffers[0] = strokebuffer->m_Handle;
         bindings.index_buffer      = {};
 
-        rive::Mat2D transformWorld  = evt.m_TransformWorld;
-        rive::Mat2D transformLocal  = evt.m_TransformLocal;
-        Mat2DToMat4(transformWorld, (float (*)[4]) m_VsUniforms.transform);
-        Mat2DToMat4(transformLocal, (float (*)[4]) m_VsUniforms.transformLocal);
+        GetPaletteTransform(evt.m_TransformWorldIdx, (float (*)[4]) m_VsUniforms.transform);
+        GetPaletteTransform(evt.m_TransformLocalIdx, (float (*)[4]) m_VsUniforms.transformLocal);
 
         sg_apply_pipeline(g_app.m_StrokePipeline);
         sg_apply_bindings(&bindings);
         sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &m_VsUniformsRange);
         if (!m_IsApplyingClipping && m_PaintDirty)
         {
-            FillPaintData(m_Paint, m_FsUniforms);
+            FillPaintData(*rive::getPaintData(g_app.m_Renderer, m_PaintId), m_FsUniforms);
             sg_apply_uniforms(SG_SHADERSTAGE_FS, SLOT_fs_paint, &m_FsUniformsRange);
             m_PaintDirty = false;
         }
-        sg_draw(evt.m_OffsetStart, evt.m_OffsetEnd - evt.m_OffsetStart, 1);
+        sg_draw(evt.m_OffsetStart, evt.m_OffsetEnd - evt.m_OffsetStart, m_InstanceCount);
     }
 
     void HandleDebugViews(const rive::PathDrawEvent& evt)
@@ -1359,18 +2323,18 @@ struct AppSTCRenderer
         App::GpuBuffer* contourIndexBuffer  = (App::GpuBuffer*) buffers.m_IndexBuffer;
         if (IS_BUFFER_VALID(contourVertexBuffer) && IS_BUFFER_VALID(contourIndexBuffer))
         {
-            const rive::PaintData paintData = rive::getPaintData(m_Paint);
+            const rive::PaintData* paintData = rive::getPaintData(g_app.m_Renderer, m_PaintId);
 
             fs_contour_t fsContourParams = {};
-            memcpy(fsContourParams.color, paintData.m_Colors, sizeof(float) * 4);
+            memcpy(fsContourParams.color, paintData->m_Colors, sizeof(float) * 4);
 
-            rive::Mat2D transformWorld  = evt.m_TransformWorld;
-            Mat2DToMat4(transformWorld, (float (*)[4]) m_VsUniforms.transform);
+            GetPaletteTransform(evt.m_TransformWorldIdx, (float (*)[4]) m_VsUniforms.transform);
 
             DebugViewContour(
                 contourVertexBuffer,
                 contourIndexBuffer,
                 contourIndexBuffer->m_DataSize / sizeof(int) - 5,
+                m_InstanceCount,
                 m_VsUniforms,
                 fsContourParams);
         }
@@ -1380,6 +2344,9 @@ struct AppSTCRenderer
 
 void AppRenderRive(uint32_t width, uint32_t height)
 {
+    UpdateTransformPalette();
+    UpdateInstanceBuffer();
+
     switch(rive::getRenderMode(g_app.m_Ctx))
     {
         case rive::MODE_TESSELLATION:
@@ -1407,22 +2374,153 @@ void AppConfigure(rive::RenderMode renderMode, float contourQuality, float* back
             ReloadArtboardContext(&g_app.m_ArtboardContexts[i]);
         }
 
+        DestroyCommandLists();
         rive::destroyRenderer(g_app.m_Renderer);
         g_app.m_Renderer = rive::createRenderer(g_app.m_Ctx);
+        InvalidateStencil();
     }
 
     rive::setClippingSupport(g_app.m_Renderer, g_app.m_DebugView == App::DEBUG_VIEW_NONE && clippingSupported);
     rive::setContourQuality(g_app.m_Renderer, contourQuality);
+    rive::setRecordingFormat(g_app.m_Renderer, g_app.m_RecordingFormat);
+    rive::setBatchingSupport(g_app.m_Renderer, g_app.m_DebugView == App::DEBUG_VIEW_NONE && g_app.m_Batching);
+}
+
+void AppSetRecordingFormat(rive::RecordingFormat format)
+{
+    g_app.m_RecordingFormat = format;
+    rive::setRecordingFormat(g_app.m_Renderer, format);
+}
+
+void AppSetBatching(bool state)
+{
+    g_app.m_Batching = state;
+}
+
+void AppSetInstancing(bool state)
+{
+    g_app.m_Instancing = state;
+}
+
+void AppSetClipRetention(bool state)
+{
+    g_app.m_ClipRetention = state;
+}
+
+void AppSetCulling(bool state)
+{
+    g_app.m_Culling = state;
+}
+
+void AppSetPauseOffscreen(bool state)
+{
+    g_app.m_PauseOffscreen = state;
+}
+
+// Tessellation mode only, opaque draws are drawn front to back first and hide what
+// is behind them from the remaining draws through the depth buffer.
+void AppSetOpaquePass(bool state)
+{
+    g_app.m_OpaquePass = state;
+}
+
+void AppSetGeometryCaching(bool state)
+{
+    rive::setGeometryCaching(g_app.m_Ctx, state);
+}
+
+// Must be called before AppBootstrap. A negative count uses one thread less than
+// the number of cores, zero records and prepares paths on the calling thread.
+void AppSetJobThreads(int threadCount)
+{
+    g_app.m_JobsDisabled   = threadCount == 0;
+    g_app.m_JobThreadCount = threadCount > 0 ? (uint32_t) threadCount : 0;
 }
 
 void AppShutdown()
 {
+    // The artboards own paths, which release their geometry to the context
+    for (int i = 0; i < App::MAX_ARTBOARD_CONTEXTS; ++i)
+    {
+        if (g_app.m_ArtboardContexts[i].m_Artboards.Size() > 0)
+        {
+            RemoveArtboardContext(i);
+        }
+    }
+
+    DestroyCommandLists();
     rive::destroyRenderer(g_app.m_Renderer);
     rive::destroyContext(g_app.m_Ctx);
+    rive::destroyThreadPool(g_app.m_ThreadPool);
+    g_app.m_TransformPalette.SetCapacity(0);
+    g_app.m_InstanceTransforms.SetCapacity(0);
+    g_app.m_Instances.SetCapacity(0);
+    g_app.m_OpaqueDraws.SetCapacity(0);
+    g_app.m_CommandLists.SetCapacity(0);
+    g_app.m_DrawJobs.SetCapacity(0);
+    AppDestroyBufferCallback((rive::HBuffer) g_app.m_InstanceBuffer, 0);
     sg_shutdown();
+#if !defined(RIVE_SOKOL_HEADLESS)
     glfwTerminate();
+#endif
+}
+
+bool AppAddArtboard(const char* path)
+{
+    for (int i = 0; i < App::MAX_ARTBOARD_CONTEXTS; ++i)
+    {
+        if (g_app.m_ArtboardContexts[i].m_Artboards.Size() == 0)
+        {
+            AddArtboardFromPath(path);
+            return g_app.m_ArtboardContexts[i].m_Artboards.Size() > 0;
+        }
+    }
+    return false;
+}
+
+void AppRemoveArtboards()
+{
+    for (int i = 0; i < App::MAX_ARTBOARD_CONTEXTS; ++i)
+    {
+        if (g_app.m_ArtboardContexts[i].m_Artboards.Size() > 0)
+        {
+            RemoveArtboardContext(i);
+        }
+    }
+}
+
+void AppSetCloneCount(int cloneCount)
+{
+    for (int i = 0; i < App::MAX_ARTBOARD_CONTEXTS; ++i)
+    {
+        App::ArtboardContext& ctx = g_app.m_ArtboardContexts[i];
+        if (ctx.m_Artboards.Size() == 0)
+        {
+            continue;
+        }
+
+        // UpdateArtboardCloneCount only adds one clone per call since
+        // the viewer calls it once per frame from the UI
+        ctx.m_CloneCount = cloneCount;
+        while ((int) ctx.m_Artboards.Size() != cloneCount)
+        {
+            UpdateArtboardCloneCount(ctx);
+        }
+    }
+}
+
+uint32_t AppGetDrawEventCount()
+{
+    return rive::getDrawEventCount(g_app.m_Renderer);
+}
+
+// Whether the stencil has to be loaded or cleared by the pass that follows AppUpdateRive
+sg_action AppGetStencilAction()
+{
+    return g_app.m_PassAction.stencil.action;
 }
 
+#if !defined(RIVE_SOKOL_HEADLESS)
 void AppRun()
 {
     int windowWidth          = 0;
@@ -1434,6 +2532,14 @@ void AppRun()
     float mouseLastY         = 0.0f;
     float backgroundColor[3] = { 0.25f, 0.25f, 0.25f };
     bool clippingSupported   = rive::getClippingSupport(g_app.m_Renderer);
+    bool compactCommands     = g_app.m_RecordingFormat == rive::RECORDING_FORMAT_COMMANDS;
+    bool batching            = g_app.m_Batching;
+    bool instancing          = g_app.m_Instancing;
+    bool clipRetention       = g_app.m_ClipRetention;
+    bool culling             = g_app.m_Culling;
+    bool pauseOffscreen      = g_app.m_PauseOffscreen;
+    bool opaquePass          = g_app.m_OpaquePass;
+    bool geometryCaching     = rive::getGeometryCaching(g_app.m_Ctx);
 
     uint64_t timeFrame;
     uint64_t timeUpdateRive;
@@ -1454,6 +2560,14 @@ void AppRun()
         ImGui::ColorEdit3("Background Color", backgroundColor);
         ImGui::SliderFloat("Path Quality", &contourQuality, 0.0f, 1.0f);
         ImGui::Checkbox("Clipping", &clippingSupported);
+        ImGui::Checkbox("Retain Clipping", &clipRetention);
+        ImGui::Checkbox("Compact Command Stream", &compactCommands);
+        ImGui::Checkbox("Batching", &batching);
+        ImGui::Checkbox("Instanced Clones", &instancing);
+        ImGui::Checkbox("Geometry Cache", &geometryCaching);
+        ImGui::Checkbox("Viewport Culling", &culling);
+        ImGui::Checkbox("Pause Off-screen Artboards", &pauseOffscreen);
+        ImGui::Checkbox("Opaque Depth Pass", &opaquePass);
 
         ImGui::Text("Render Mode");
         ImGui::RadioButton("Tessellation", &renderModeChoice, (int) rive::MODE_TESSELLATION);
@@ -1529,6 +2643,14 @@ void AppRun()
         mouseLastX = io.MousePos.x;
         mouseLastY = io.MousePos.y;
 
+        AppSetRecordingFormat(compactCommands ? rive::RECORDING_FORMAT_COMMANDS : rive::RECORDING_FORMAT_EVENTS);
+        AppSetBatching(batching);
+        AppSetInstancing(instancing);
+        AppSetClipRetention(clipRetention);
+        AppSetCulling(culling);
+        AppSetPauseOffscreen(pauseOffscreen);
+        AppSetOpaquePass(opaquePass);
+        AppSetGeometryCaching(geometryCaching);
         AppConfigure((rive::RenderMode) renderModeChoice, contourQuality, backgroundColor, clippingSupported);
 
         timeUpdateRive = stm_now();
@@ -1551,3 +2673,4 @@ void AppRun()
         glfwPollEvents();
     }
 }
+#endif
@@ -0,0 +1,93 @@
+#ifndef _RIVE_SOKOL_BENCH_H_
+#define _RIVE_SOKOL_BENCH_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+// Small helpers shared by the benchmark binaries. Timings are collected per
+// sample in milliseconds and reduced to min / median / p99 / mean.
+namespace bench
+{
+    struct Stats
+    {
+        double m_Min;
+        double m_Median;
+        double m_P99;
+        double m_Mean;
+    };
+
+    static Stats computeStats(std::vector<double>& samples)
+    {
+        Stats stats = {};
+        if (samples.size() == 0)
+        {
+            return stats;
+        }
+
+        std::sort(samples.begin(), samples.end());
+
+        double sum = 0.0;
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            sum += samples[i];
+        }
+
+        size_t p99Index = (size_t) ((samples.size() - 1) * 0.99 + 0.5);
+        stats.m_Min     = samples[0];
+        stats.m_Median  = samples[samples.size() / 2];
+        stats.m_P99     = samples[p99Index];
+        stats.m_Mean    = sum / (double) samples.size();
+        return stats;
+    }
+
+    static void printStats(const char* label, const Stats& stats)
+    {
+        printf("    %-12s min %9.4f  median %9.4f  p99 %9.4f  mean %9.4f ms\n",
+            label, stats.m_Min, stats.m_Median, stats.m_P99, stats.m_Mean);
+    }
+
+    static void writeJsonStats(FILE* fp, const char* name, const Stats& stats)
+    {
+        fprintf(fp, "\"%s\": { \"min\": %.6f, \"median\": %.6f, \"p99\": %.6f, \"mean\": %.6f }",
+            name, stats.m_Min, stats.m_Median, stats.m_P99, stats.m_Mean);
+    }
+
+    // Writes a JSON string, escaping the characters that can show up in paths
+    static void writeJsonString(FILE* fp, const char* str)
+    {
+        fputc('"', fp);
+        for (const char* c = str; *c; ++c)
+        {
+            if (*c == '"' || *c == '\\')
+            {
+                fputc('\\', fp);
+            }
+            fputc(*c, fp);
+        }
+        fputc('"', fp);
+    }
+
+    // Parses a comma separated list of positive integers, e.g "1,4,10"
+    static bool parseIntList(const char* str, std::vector<int>& out)
+    {
+        out.clear();
+        while (*str)
+        {
+            char* end = 0;
+            long v = strtol(str, &end, 10);
+            if (end == str || v <= 0)
+            {
+                return false;
+            }
+            out.push_back((int) v);
+            str = *end == ',' ? end + 1 : end;
+        }
+        return out.size() > 0;
+    }
+}
+
+#endif
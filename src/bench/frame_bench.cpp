@@ -0,0 +1,460 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+
+#include <string>
+#include <vector>
+
+#include <sokol_gfx.h>
+#include <sokol_time.h>
+
+#include <rive/renderer.hpp>
+
+#include "rive/rive_render_api.h"
+#include "bench/bench.h"
+
+// Headless frame benchmark. Drives the same AppUpdateRive / AppRenderRive loop
+// as the viewer, but against sokol's dummy backend so no window or GL context
+// is needed. Every .riv file is measured in isolation for every render mode and
+// clone count combination.
+
+extern bool      AppBootstrap(int argc, char const *argv[]);
+extern void      AppShutdown();
+extern void      AppUpdateRive(float dt, uint32_t width, uint32_t height);
+extern void      AppRenderRive(uint32_t width, uint32_t height);
+extern void      AppConfigure(rive::RenderMode renderMode, float contourQuality, float* backgroundColor, bool clippingSupported);
+extern bool      AppAddArtboard(const char* path);
+extern void      AppRemoveArtboards();
+extern void      AppSetCloneCount(int cloneCount);
+extern uint32_t  AppGetDrawEventCount();
+extern sg_action AppGetStencilAction();
+extern void      AppSetRecordingFormat(rive::RecordingFormat format);
+extern void      AppSetBatching(bool state);
+extern void      AppSetInstancing(bool state);
+extern void      AppSetGeometryCaching(bool state);
+extern void      AppSetCulling(bool state);
+extern void      AppSetClipRetention(bool state);
+extern void      AppSetPauseOffscreen(bool state);
+extern void      AppSetOpaquePass(bool state);
+extern void      AppSetJobThreads(int threadCount);
+
+#define BENCH_DEFAULT_ASSET_DIR "assets/riv"
+
+struct BenchConfig
+{
+    std::vector<std::string>      m_Files;
+    std::vector<int>              m_CloneCounts;
+    std::vector<rive::RenderMode> m_Modes;
+    const char*                   m_JsonPath;
+    int                           m_Frames;
+    int                           m_WarmupFrames;
+    uint32_t                      m_Width;
+    uint32_t                      m_Height;
+    float                         m_ContourQuality;
+    bool                          m_Clipping;
+    bool                          m_Commands;
+    bool                          m_Batching;
+    bool                          m_Instancing;
+    bool                          m_GeometryCaching;
+    bool                          m_Culling;
+    bool                          m_ClipRetention;
+    bool                          m_PauseOffscreen;
+    bool                          m_OpaquePass;
+    int                           m_JobThreads;
+};
+
+struct BenchResult
+{
+    std::string      m_File;
+    rive::RenderMode m_Mode;
+    int              m_CloneCount;
+    uint32_t         m_DrawEventCount;
+    bench::Stats     m_Update;
+    bench::Stats     m_Render;
+    bench::Stats     m_Frame;
+};
+
+static const char* GetRenderModeName(rive::RenderMode mode)
+{
+    switch(mode)
+    {
+        case rive::MODE_TESSELLATION:     return "tessellation";
+        case rive::MODE_STENCIL_TO_COVER: return "stencil_to_cover";
+        default:break;
+    }
+    return "unknown";
+}
+
+static void PrintUsage(const char* exe)
+{
+    printf("Usage: %s [options] [file.riv ...]\n", exe);
+    printf("  --frames N       Measured frames per run (default 300)\n");
+    printf("  --warmup N       Frames discarded before measuring (default 30)\n");
+    printf("  --clones A,B,..  Clone counts to measure (default 1,4,10)\n");
+    printf("  --mode M         tessellation, stc or all (default all)\n");
+    printf("  --size WxH       Framebuffer size (default 1280x720)\n");
+    printf("  --quality Q      Contour quality in [0,1] (default 0.89)\n");
+    printf("  --no-clipping    Disable clipping support\n");
+    printf("  --commands       Record into the compact command stream instead of draw events\n");
+    printf("  --no-batching    Draw every tessellated fill on its own instead of batching solid fills\n");
+    printf("  --no-instancing  Record and draw every clone separately instead of instancing the first one\n");
+    printf("  --no-geometry-cache  Tessellate and upload every path separately, even if identical\n");
+    printf("  --culling        Skip clones outside the viewport, off by default since clones are laid out past it\n");
+    printf("  --retain-clipping  Keep clip masks in the stencil buffer across frames\n");
+    printf("  --pause-offscreen  Stop advancing culled clones, only has an effect together with --culling\n");
+    printf("  --opaque-pass    Draw opaque tessellated fills front to back before everything else\n");
+    printf("  --threads N      Worker threads for recording and path preparation, 0 runs everything serially (default cores - 1)\n");
+    printf("  --json PATH      Write a JSON report to PATH\n");
+    printf("Without any files, all .riv files in '%s' are used.\n", BENCH_DEFAULT_ASSET_DIR);
+}
+
+static void CollectAssetFiles(const char* dirPath, std::vector<std::string>& files)
+{
+    DIR* dir = opendir(dirPath);
+    if (dir == 0)
+    {
+        fprintf(stderr, "Failed to open directory '%s'\n", dirPath);
+        return;
+    }
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != 0)
+    {
+        size_t len = strlen(entry->d_name);
+        if (len > 4 && strcmp(entry->d_name + len - 4, ".riv") == 0)
+        {
+            files.push_back(std::string(dirPath) + "/" + entry->d_name);
+        }
+    }
+    closedir(dir);
+
+    // readdir order is filesystem dependent, keep reports comparable
+    std::sort(files.begin(), files.end());
+}
+
+static bool ParseArgs(int argc, char const *argv[], BenchConfig& cfg)
+{
+    cfg.m_Frames         = 300;
+    cfg.m_WarmupFrames   = 30;
+    cfg.m_Width          = 1280;
+    cfg.m_Height         = 720;
+    cfg.m_ContourQuality = 0.8888888888888889f;
+    cfg.m_Clipping       = true;
+    cfg.m_Commands       = false;
+    cfg.m_Batching       = true;
+    cfg.m_Instancing     = true;
+    cfg.m_GeometryCaching = true;
+    cfg.m_Culling        = false;
+    cfg.m_ClipRetention  = false;
+    cfg.m_PauseOffscreen = false;
+    cfg.m_OpaquePass     = false;
+    cfg.m_JobThreads     = -1;
+    cfg.m_JsonPath       = 0;
+    cfg.m_CloneCounts    = { 1, 4, 10 };
+    cfg.m_Modes          = { rive::MODE_TESSELLATION, rive::MODE_STENCIL_TO_COVER };
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* arg     = argv[i];
+        const char* nextArg = (i + 1) < argc ? argv[i + 1] : 0;
+        bool needsValue     = strncmp(arg, "--", 2) == 0 &&
+            strcmp(arg, "--no-clipping") != 0 && strcmp(arg, "--commands") != 0 &&
+            strcmp(arg, "--no-batching") != 0 && strcmp(arg, "--no-instancing") != 0 &&
+            strcmp(arg, "--no-geometry-cache") != 0 && strcmp(arg, "--culling") != 0 &&
+            strcmp(arg, "--retain-clipping") != 0 && strcmp(arg, "--pause-offscreen") != 0 &&
+            strcmp(arg, "--opaque-pass") != 0 && strcmp(arg, "--help") != 0;
+
+        if (needsValue && nextArg == 0)
+        {
+            fprintf(stderr, "Missing value for '%s'\n", arg);
+            return false;
+        }
+
+        if (strcmp(arg, "--help") == 0)
+        {
+            return false;
+        }
+        else if (strcmp(arg, "--frames") == 0)
+        {
+            cfg.m_Frames = atoi(nextArg);
+            i++;
+        }
+        else if (strcmp(arg, "--warmup") == 0)
+        {
+            cfg.m_WarmupFrames = atoi(nextArg);
+            i++;
+        }
+        else if (strcmp(arg, "--clones") == 0)
+        {
+            if (!bench::parseIntList(nextArg, cfg.m_CloneCounts))
+            {
+                fprintf(stderr, "Invalid clone count list '%s'\n", nextArg);
+                return false;
+            }
+            i++;
+        }
+        else if (strcmp(arg, "--mode") == 0)
+        {
+            if (strcmp(nextArg, "tessellation") == 0)
+            {
+                cfg.m_Modes = { rive::MODE_TESSELLATION };
+            }
+            else if (strcmp(nextArg, "stc") == 0)
+            {
+                cfg.m_Modes = { rive::MODE_STENCIL_TO_COVER };
+            }
+            else if (strcmp(nextArg, "all") != 0)
+            {
+                fprintf(stderr, "Unknown render mode '%s'\n", nextArg);
+                return false;
+            }
+            i++;
+        }
+        else if (strcmp(arg, "--size") == 0)
+        {
+            if (sscanf(nextArg, "%ux%u", &cfg.m_Width, &cfg.m_Height) != 2)
+            {
+                fprintf(stderr, "Invalid size '%s'\n", nextArg);
+                return false;
+            }
+            i++;
+        }
+        else if (strcmp(arg, "--quality") == 0)
+        {
+            cfg.m_ContourQuality = (float) atof(nextArg);
+            i++;
+        }
+        else if (strcmp(arg, "--threads") == 0)
+        {
+            cfg.m_JobThreads = atoi(nextArg);
+            i++;
+        }
+        else if (strcmp(arg, "--json") == 0)
+        {
+            cfg.m_JsonPath = nextArg;
+            i++;
+        }
+        else if (strcmp(arg, "--no-clipping") == 0)
+        {
+            cfg.m_Clipping = false;
+        }
+        else if (strcmp(arg, "--commands") == 0)
+        {
+            cfg.m_Commands = true;
+        }
+        else if (strcmp(arg, "--no-batching") == 0)
+        {
+            cfg.m_Batching = false;
+        }
+        else if (strcmp(arg, "--no-instancing") == 0)
+        {
+            cfg.m_Instancing = false;
+        }
+        else if (strcmp(arg, "--no-geometry-cache") == 0)
+        {
+            cfg.m_GeometryCaching = false;
+        }
+        else if (strcmp(arg, "--culling") == 0)
+        {
+            cfg.m_Culling = true;
+        }
+        else if (strcmp(arg, "--retain-clipping") == 0)
+        {
+            cfg.m_ClipRetention = true;
+        }
+        else if (strcmp(arg, "--pause-offscreen") == 0)
+        {
+            cfg.m_PauseOffscreen = true;
+        }
+        else if (strcmp(arg, "--opaque-pass") == 0)
+        {
+            cfg.m_OpaquePass = true;
+        }
+        else if (strncmp(arg, "--", 2) == 0)
+        {
+            fprintf(stderr, "Unknown option '%s'\n", arg);
+            return false;
+        }
+        else
+        {
+            cfg.m_Files.push_back(arg);
+        }
+    }
+
+    if (cfg.m_Files.size() == 0)
+    {
+        CollectAssetFiles(BENCH_DEFAULT_ASSET_DIR, cfg.m_Files);
+    }
+
+    return cfg.m_Frames > 0 && cfg.m_WarmupFrames >= 0 && cfg.m_Files.size() > 0;
+}
+
+static bool RunBenchmark(const BenchConfig& cfg, const std::string& file, rive::RenderMode mode, int cloneCount, BenchResult& result)
+{
+    float backgroundColor[3] = { 0.25f, 0.25f, 0.25f };
+    const float dt           = 1.0f / 60.0f;
+
+    AppRemoveArtboards();
+    AppSetRecordingFormat(cfg.m_Commands ? rive::RECORDING_FORMAT_COMMANDS : rive::RECORDING_FORMAT_EVENTS);
+    AppSetBatching(cfg.m_Batching);
+    AppSetInstancing(cfg.m_Instancing);
+    AppSetGeometryCaching(cfg.m_GeometryCaching);
+    AppSetCulling(cfg.m_Culling);
+    AppSetClipRetention(cfg.m_ClipRetention);
+    AppSetPauseOffscreen(cfg.m_PauseOffscreen);
+    AppSetOpaquePass(cfg.m_OpaquePass);
+    AppConfigure(mode, cfg.m_ContourQuality, backgroundColor, cfg.m_Clipping);
+
+    if (!AppAddArtboard(file.c_str()))
+    {
+        return false;
+    }
+
+    AppSetCloneCount(cloneCount);
+
+    sg_pass_action passAction   = {};
+    passAction.colors[0].action = SG_ACTION_CLEAR;
+
+    std::vector<double> updateSamples;
+    std::vector<double> renderSamples;
+    std::vector<double> frameSamples;
+    updateSamples.reserve(cfg.m_Frames);
+    renderSamples.reserve(cfg.m_Frames);
+    frameSamples.reserve(cfg.m_Frames);
+
+    for (int i = 0; i < cfg.m_WarmupFrames + cfg.m_Frames; ++i)
+    {
+        uint64_t timeFrame  = stm_now();
+        uint64_t timeUpdate = stm_now();
+        AppUpdateRive(dt, cfg.m_Width, cfg.m_Height);
+        timeUpdate = stm_since(timeUpdate);
+
+        // Retained clips are only valid if the stencil survives into this pass
+        passAction.stencil.action = AppGetStencilAction();
+        sg_begin_default_pass(&passAction, cfg.m_Width, cfg.m_Height);
+        uint64_t timeRender = stm_now();
+        AppRenderRive(cfg.m_Width, cfg.m_Height);
+        timeRender = stm_since(timeRender);
+        sg_end_pass();
+        sg_commit();
+        timeFrame = stm_since(timeFrame);
+
+        if (i >= cfg.m_WarmupFrames)
+        {
+            updateSamples.push_back(stm_ms(timeUpdate));
+            renderSamples.push_back(stm_ms(timeRender));
+            frameSamples.push_back(stm_ms(timeFrame));
+        }
+    }
+
+    result.m_File           = file;
+    result.m_Mode           = mode;
+    result.m_CloneCount     = cloneCount;
+    result.m_DrawEventCount = AppGetDrawEventCount();
+    result.m_Update         = bench::computeStats(updateSamples);
+    result.m_Render         = bench::computeStats(renderSamples);
+    result.m_Frame          = bench::computeStats(frameSamples);
+    return true;
+}
+
+static bool WriteJsonReport(const char* path, const BenchConfig& cfg, const std::vector<BenchResult>& results)
+{
+    FILE* fp = fopen(path, "w");
+    if (fp == 0)
+    {
+        fprintf(stderr, "Failed to open '%s' for writing\n", path);
+        return false;
+    }
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"frames\": %d,\n", cfg.m_Frames);
+    fprintf(fp, "  \"warmup\": %d,\n", cfg.m_WarmupFrames);
+    fprintf(fp, "  \"width\": %u,\n", cfg.m_Width);
+    fprintf(fp, "  \"height\": %u,\n", cfg.m_Height);
+    fprintf(fp, "  \"contour_quality\": %.4f,\n", cfg.m_ContourQuality);
+    fprintf(fp, "  \"clipping\": %s,\n", cfg.m_Clipping ? "true" : "false");
+    fprintf(fp, "  \"recording_format\": \"%s\",\n", cfg.m_Commands ? "commands" : "events");
+    fprintf(fp, "  \"batching\": %s,\n", cfg.m_Batching ? "true" : "false");
+    fprintf(fp, "  \"instancing\": %s,\n", cfg.m_Instancing ? "true" : "false");
+    fprintf(fp, "  \"geometry_cache\": %s,\n", cfg.m_GeometryCaching ? "true" : "false");
+    fprintf(fp, "  \"culling\": %s,\n", cfg.m_Culling ? "true" : "false");
+    fprintf(fp, "  \"clip_retention\": %s,\n", cfg.m_ClipRetention ? "true" : "false");
+    fprintf(fp, "  \"pause_offscreen\": %s,\n", cfg.m_PauseOffscreen ? "true" : "false");
+    fprintf(fp, "  \"opaque_pass\": %s,\n", cfg.m_OpaquePass ? "true" : "false");
+    fprintf(fp, "  \"job_threads\": %d,\n", cfg.m_JobThreads);
+    fprintf(fp, "  \"runs\": [\n");
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchResult& r = results[i];
+        fprintf(fp, "    { \"file\": ");
+        bench::writeJsonString(fp, r.m_File.c_str());
+        fprintf(fp, ", \"mode\": \"%s\", \"clones\": %d, \"draw_events\": %u,\n      ",
+            GetRenderModeName(r.m_Mode), r.m_CloneCount, r.m_DrawEventCount);
+        bench::writeJsonStats(fp, "update_ms", r.m_Update);
+        fprintf(fp, ",\n      ");
+        bench::writeJsonStats(fp, "render_ms", r.m_Render);
+        fprintf(fp, ",\n      ");
+        bench::writeJsonStats(fp, "frame_ms", r.m_Frame);
+        fprintf(fp, " }%s\n", (i + 1) < results.size() ? "," : "");
+    }
+
+    fprintf(fp, "  ]\n}\n");
+    fclose(fp);
+    return true;
+}
+
+int main(int argc, char const *argv[])
+{
+    BenchConfig cfg;
+    if (!ParseArgs(argc, argv, cfg))
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    // Artboards are added per run, so don't forward any arguments
+    AppSetJobThreads(cfg.m_JobThreads);
+    if (!AppBootstrap(1, argv))
+    {
+        return 1;
+    }
+
+    std::vector<BenchResult> results;
+    bool success = true;
+
+    for (size_t f = 0; f < cfg.m_Files.size(); ++f)
+    {
+        for (size_t m = 0; m < cfg.m_Modes.size(); ++m)
+        {
+            for (size_t c = 0; c < cfg.m_CloneCounts.size(); ++c)
+            {
+                BenchResult result;
+                if (!RunBenchmark(cfg, cfg.m_Files[f], cfg.m_Modes[m], cfg.m_CloneCounts[c], result))
+                {
+                    fprintf(stderr, "Failed to run benchmark for '%s'\n", cfg.m_Files[f].c_str());
+                    success = false;
+                    continue;
+                }
+
+                printf("%s [%s, clones: %d, draw events: %u]\n", result.m_File.c_str(),
+                    GetRenderModeName(result.m_Mode), result.m_CloneCount, result.m_DrawEventCount);
+                bench::printStats("update", result.m_Update);
+                bench::printStats("render", result.m_Render);
+                bench::printStats("frame", result.m_Frame);
+                results.push_back(result);
+            }
+        }
+    }
+
+    AppRemoveArtboards();
+    AppShutdown();
+
+    if (cfg.m_JsonPath && !WriteJsonReport(cfg.m_JsonPath, cfg, results))
+    {
+        success = false;
+    }
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,870 @@
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <jc/array.h>
+
+#include <rive/renderer.hpp>
+#include <rive/contour_render_path.hpp>
+#include <rive/contour_stroke.hpp>
+
+#include "rive/rive_render_api.h"
+#include "rive/rive_render_private.h"
+#include "bench/bench.h"
+
+// Micro benchmarks for the hot functions of librivesokol. Only the render
+// library is linked, GPU buffers are replaced by callbacks that count the
+// uploaded bytes. Every benchmark is run over a matrix of path complexities
+// (subpath count x cubic segments per subpath) so scaling can be compared.
+
+namespace rive
+{
+    // Only needed to satisfy the rive runtime, nothing is imported here
+    RenderPath*  makeRenderPath()  { return 0; }
+    RenderPaint* makeRenderPaint() { return 0; }
+}
+
+struct BufferStats
+{
+    uint64_t m_UploadedBytes;
+    uint64_t m_VertexBytes;
+    uint32_t m_Requests;
+    uint32_t m_Destroys;
+    uint32_t m_NextHandle;
+};
+
+struct BenchConfig
+{
+    const char* m_JsonPath;
+    const char* m_Filter;
+    int         m_Iterations;
+};
+
+struct BenchShape
+{
+    int      m_SubPaths;
+    int      m_Segments;
+    uint32_t m_Vertices;
+};
+
+struct BenchResult
+{
+    std::string  m_Name;
+    BenchShape   m_Shape;
+    int          m_Count;
+    uint64_t     m_UploadedBytes;
+    bench::Stats m_Stats;
+};
+
+static BufferStats g_BufferStats;
+
+static rive::HBuffer BenchRequestBufferCallback(rive::HBuffer buffer, rive::BufferType type, void* data, unsigned int dataSize, void* userData)
+{
+    BufferStats* stats = (BufferStats*) userData;
+    stats->m_UploadedBytes += dataSize;
+    stats->m_VertexBytes   += type == rive::BUFFER_TYPE_VERTEX_BUFFER ? dataSize : 0;
+    stats->m_Requests++;
+    return buffer ? buffer : (rive::HBuffer) ++stats->m_NextHandle;
+}
+
+static void BenchDestroyBufferCallback(rive::HBuffer buffer, void* userData)
+{
+    BufferStats* stats = (BufferStats*) userData;
+    stats->m_Destroys++;
+}
+
+typedef std::chrono::steady_clock BenchClock;
+
+static inline double ElapsedMs(BenchClock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(BenchClock::now() - start).count();
+}
+
+static rive::HContext CreateBenchContext(rive::RenderMode mode)
+{
+    rive::HContext ctx = rive::createContext();
+    rive::setBufferCallbacks(ctx, BenchRequestBufferCallback, BenchDestroyBufferCallback, &g_BufferStats);
+    rive::setRenderMode(ctx, mode);
+    return ctx;
+}
+
+static rive::SharedRenderer* CreateBenchRenderer(rive::HContext ctx)
+{
+    rive::HRenderer renderer = rive::createRenderer(ctx);
+    rive::setClippingSupport(renderer, false);
+    rive::setContourQuality(renderer, 0.8888888888888889f);
+    rive::newFrame(renderer);
+    return (rive::SharedRenderer*) renderer;
+}
+
+// A wavy closed contour made from cubic segments around a circle, without
+// wobble the contour is convex
+static void BuildSubPath(rive::RenderPath* path, int segments, float wobble)
+{
+    const float radius   = 100.0f;
+    const float step     = (float) (2.0 * M_PI) / (float) segments;
+    const float handle   = radius * 4.0f / 3.0f * tanf(step / 4.0f);
+
+    path->reset();
+    path->moveTo(radius, 0.0f);
+
+    for (int i = 0; i < segments; ++i)
+    {
+        float a0 = step * i;
+        float a1 = step * (i + 1);
+        float r1 = radius + ((i % 2) ? wobble : -wobble);
+        path->cubicTo(
+            radius * cosf(a0) - handle * sinf(a0), radius * sinf(a0) + handle * cosf(a0),
+            r1 * cosf(a1) + handle * sinf(a1), r1 * sinf(a1) - handle * cosf(a1),
+            (i + 1) == segments ? radius : r1 * cosf(a1),
+            (i + 1) == segments ? 0.0f   : r1 * sinf(a1));
+    }
+
+    path->close();
+}
+
+struct BenchPath
+{
+    rive::RenderPath*              m_Container;
+    std::vector<rive::RenderPath*> m_SubPaths;
+    int                            m_Segments;
+    float                          m_Wobble;
+
+    void Create(rive::HContext ctx, int subPaths, int segments, float wobble = 20.0f)
+    {
+        m_Container = rive::createRenderPath(ctx);
+        m_Container->fillRule(rive::FillRule::nonZero);
+        m_Segments  = segments;
+        m_Wobble    = wobble;
+
+        for (int i = 0; i < subPaths; ++i)
+        {
+            rive::RenderPath* subPath = rive::createRenderPath(ctx);
+            subPath->fillRule(rive::FillRule::nonZero);
+            BuildSubPath(subPath, segments, wobble);
+            m_SubPaths.push_back(subPath);
+        }
+
+        AddSubPaths();
+    }
+
+    void AddSubPaths()
+    {
+        for (size_t i = 0; i < m_SubPaths.size(); ++i)
+        {
+            rive::Mat2D offset;
+            offset[4] = 250.0f * (i % 8);
+            offset[5] = 250.0f * (i / 8);
+            m_Container->addRenderPath(m_SubPaths[i], offset);
+        }
+    }
+
+    // Rebuilding the commands is what makes the paths dirty again
+    void Invalidate()
+    {
+        for (size_t i = 0; i < m_SubPaths.size(); ++i)
+        {
+            BuildSubPath(m_SubPaths[i], m_Segments, m_Wobble);
+        }
+        m_Container->reset();
+        AddSubPaths();
+    }
+
+    // Like an animated rig where only one part moves, the container is still rebuilt
+    void InvalidateFirst()
+    {
+        BuildSubPath(m_SubPaths[0], m_Segments, m_Wobble);
+        m_Container->reset();
+        AddSubPaths();
+    }
+
+    void Destroy()
+    {
+        delete m_Container;
+        for (size_t i = 0; i < m_SubPaths.size(); ++i)
+        {
+            delete m_SubPaths[i];
+        }
+        m_SubPaths.clear();
+    }
+};
+
+static const int g_SubPathCounts[] = { 1, 4, 16 };
+static const int g_SegmentCounts[] = { 4, 16, 64, 256 };
+
+// Flattened vertex count for a shape, measured from the contour upload of the
+// stencil to cover path, which uploads the contour plus 4 bounds vertices
+static uint32_t MeasureFlattenedVertices(int subPaths, int segments)
+{
+    rive::HContext ctx             = CreateBenchContext(rive::MODE_STENCIL_TO_COVER);
+    rive::SharedRenderer* renderer = CreateBenchRenderer(ctx);
+    BenchPath path;
+    path.Create(ctx, subPaths, segments);
+
+    g_BufferStats.m_VertexBytes = 0;
+    for (size_t i = 0; i < path.m_SubPaths.size(); ++i)
+    {
+        rive::StencilToCoverRenderPath* stcPath = (rive::StencilToCoverRenderPath*) path.m_SubPaths[i];
+        stcPath->updateContour();
+        stcPath->updateBuffers(renderer);
+    }
+
+    uint32_t vertices = (uint32_t) (g_BufferStats.m_VertexBytes / (sizeof(float) * 2)) - 4 * subPaths;
+
+    path.Destroy();
+    rive::destroyRenderer((rive::HRenderer) renderer);
+    rive::destroyContext(ctx);
+    return vertices;
+}
+
+typedef void (*ShapeBenchFn)(const BenchConfig& cfg, const BenchShape& shape, BenchResult& result);
+typedef void (*CountBenchFn)(const BenchConfig& cfg, int count, BenchResult& result);
+
+static void BenchTessellationUpdate(const BenchConfig& cfg, const BenchShape& shape, bool geometryCaching, bool onlyFirst, BenchResult& result)
+{
+    rive::HContext ctx             = CreateBenchContext(rive::MODE_TESSELLATION);
+    rive::SharedRenderer* renderer = CreateBenchRenderer(ctx);
+    BenchPath path;
+    path.Create(ctx, shape.m_SubPaths, shape.m_Segments);
+
+    // The geometry doesn't change between iterations, so with the cache it is only
+    // tessellated once and the rest measures contouring and the cache lookup.
+    rive::setGeometryCaching(ctx, geometryCaching);
+
+    rive::TessellationRenderPath* tessPath = (rive::TessellationRenderPath*) path.m_Container;
+    std::vector<double> samples;
+    g_BufferStats.m_UploadedBytes = 0;
+
+    for (int i = 0; i < cfg.m_Iterations; ++i)
+    {
+        if (onlyFirst)
+        {
+            path.InvalidateFirst();
+        }
+        else
+        {
+            path.Invalidate();
+        }
+
+        BenchClock::time_point start = BenchClock::now();
+        tessPath->updateTesselation();
+        samples.push_back(ElapsedMs(start));
+    }
+
+    result.m_UploadedBytes = g_BufferStats.m_UploadedBytes / cfg.m_Iterations;
+    result.m_Stats         = bench::computeStats(samples);
+
+    path.Destroy();
+    rive::destroyRenderer((rive::HRenderer) renderer);
+    rive::destroyContext(ctx);
+}
+
+static void BenchTessellation(const BenchConfig& cfg, const BenchShape& shape, BenchResult& result)
+{
+    BenchTessellationUpdate(cfg, shape, false, false, result);
+}
+
+static void BenchTessellationCached(const BenchConfig& cfg, const BenchShape& shape, BenchResult& result)
+{
+    BenchTessellationUpdate(cfg, shape, true, false, result);
+}
+
+static void BenchTessellationFirstSubPath(const BenchConfig& cfg, const BenchShape& shape, BenchResult& result)
+{
+    BenchTessellationUpdate(cfg, shape, false, true, result);
+}
+
+static void BenchFlattenContour(const BenchConfig& cfg, const BenchShape& shape, BenchResult& result)
+{
+    rive::HContext ctx = CreateBenchContext(rive::MODE_TESSELLATION);
+    BenchPath path;
+    path.Create(ctx, shape.m_SubPaths, shape.m_Segments);
+
+    std::vector<double> samples;
+    uint64_t vertexBytes = 0;
+
+    for (int i = 0; i < cfg.m_Iterations; ++i)
+    {
+        path.Invalidate();
+        BenchClock::time_point start = BenchClock::now();
+        ((rive::SharedRenderPath*) path.m_Container)->updateContour();
+        samples.push_back(ElapsedMs(start));
+
+        for (size_t j = 0; j < path.m_SubPaths.size(); ++j)
+        {
+            vertexBytes += ((rive::SharedRenderPath*) path.m_SubPaths[j])->m_Contour.Size() * sizeof(float);
+        }
+    }
+
+    result.m_UploadedBytes = vertexBytes / cfg.m_Iterations;
+    result.m_Stats         = bench::computeStats(samples);
+
+    path.Destroy();
+    rive::destroyContext(ctx);
+}
+
+// Triangulates every subpath as its own single contour, either with the direct
+// triangulation (falling back to libtess2 where needed) or with libtess2 only
+static void BenchTriangulate(const BenchConfig& cfg, const BenchShape& shape, float wobble, bool useLibtess2, BenchResult& result)
+{
+    rive::HContext ctx             = CreateBenchContext(rive::MODE_TESSELLATION);
+    rive::SharedRenderer* renderer = CreateBenchRenderer(ctx);
+    BenchPath path;
+    path.Create(ctx, shape.m_SubPaths, shape.m_Segments, wobble);
+    rive::setGeometryCaching(ctx, false);
+
+    for (size_t i = 0; i < path.m_SubPaths.size(); ++i)
+    {
+        rive::TessellationRenderPath* tessPath = (rive::TessellationRenderPath*) path.m_SubPaths[i];
+        tessPath->updateContour();
+        tessPath->prepareBuffers();
+        tessPath->resolveBuffers();
+    }
+
+    std::vector<double> samples;
+    uint64_t indexCount = 0;
+
+    for (int i = 0; i < cfg.m_Iterations; ++i)
+    {
+        BenchClock::time_point start = BenchClock::now();
+        for (size_t j = 0; j < path.m_SubPaths.size(); ++j)
+        {
+            rive::GeometryCacheEntry* geometry = ((rive::TessellationRenderPath*) path.m_SubPaths[j])->m_Geometry;
+            if (useLibtess2 || !rive::triangulateSimpleContour(geometry))
+            {
+                rive::tessellateContours(geometry);
+            }
+            indexCount += geometry->m_Indices.Size();
+        }
+        samples.push_back(ElapsedMs(start));
+    }
+
+    result.m_UploadedBytes = indexCount * sizeof(int) / cfg.m_Iterations;
+    result.m_Stats         = bench::computeStats(samples);
+
+    path.Destroy();
+    rive::destroyRenderer((rive::HRenderer) renderer);
+    rive::destroyContext(ctx);
+}
+
+static void BenchTriangulateSimple(const BenchConfig& cfg, const BenchShape& shape, BenchResult& result)
+{
+    BenchTriangulate(cfg, shape, 20.0f, false, result);
+}
+
+static void BenchTriangulateSimpleLibtess2(const BenchConfig& cfg, const BenchShape& shape, BenchResult& result)
+{
+    BenchTriangulate(cfg, shape, 20.0f, true, result);
+}
+
+static void BenchTriangulateConvex(const BenchConfig& cfg, const BenchShape& shape, BenchResult& result)
+{
+    BenchTriangulate(cfg, shape, 0.0f, false, result);
+}
+
+static void BenchTriangulateConvexLibtess2(const BenchConfig& cfg, const BenchShape& shape, BenchResult& result)
+{
+    BenchTriangulate(cfg, shape, 0.0f, true, result);
+}
+
+static void BenchStencil(const BenchConfig& cfg, const BenchShape& shape, BenchResult& result)
+{
+    rive::HContext ctx             = CreateBenchContext(rive::MODE_STENCIL_TO_COVER);
+    rive::SharedRenderer* renderer = CreateBenchRenderer(ctx);
+    BenchPath path;
+    path.Create(ctx, shape.m_SubPaths, shape.m_Segments);
+
+    rive::StencilToCoverRenderPath* stcPath = (rive::StencilToCoverRenderPath*) path.m_Container;
+    rive::Mat2D transform;
+    std::vector<double> samples;
+    g_BufferStats.m_UploadedBytes = 0;
+
+    for (int i = 0; i < cfg.m_Iterations; ++i)
+    {
+        path.Invalidate();
+        rive::newFrame((rive::HRenderer) renderer);
+        BenchClock::time_point start = BenchClock::now();
+        stcPath->stencil(renderer, transform, 0, false, false);
+        samples.push_back(ElapsedMs(start));
+    }
+
+    result.m_UploadedBytes = g_BufferStats.m_UploadedBytes / cfg.m_Iterations;
+    result.m_Stats         = bench::computeStats(samples);
+
+    path.Destroy();
+    rive::destroyRenderer((rive::HRenderer) renderer);
+    rive::destroyContext(ctx);
+}
+
+static void BenchStencilUpdateBuffers(const BenchConfig& cfg, const BenchShape& shape, BenchResult& result)
+{
+    rive::HContext ctx             = CreateBenchContext(rive::MODE_STENCIL_TO_COVER);
+    rive::SharedRenderer* renderer = CreateBenchRenderer(ctx);
+    BenchPath path;
+    path.Create(ctx, shape.m_SubPaths, shape.m_Segments);
+
+    for (size_t i = 0; i < path.m_SubPaths.size(); ++i)
+    {
+        ((rive::StencilToCoverRenderPath*) path.m_SubPaths[i])->updateContour();
+    }
+
+    std::vector<double> samples;
+    g_BufferStats.m_UploadedBytes = 0;
+
+    for (int i = 0; i < cfg.m_Iterations; ++i)
+    {
+        BenchClock::time_point start = BenchClock::now();
+        for (size_t j = 0; j < path.m_SubPaths.size(); ++j)
+        {
+            ((rive::StencilToCoverRenderPath*) path.m_SubPaths[j])->updateBuffers(renderer);
+        }
+        samples.push_back(ElapsedMs(start));
+    }
+
+    result.m_UploadedBytes = g_BufferStats.m_UploadedBytes / cfg.m_Iterations;
+    result.m_Stats         = bench::computeStats(samples);
+
+    path.Destroy();
+    rive::destroyRenderer((rive::HRenderer) renderer);
+    rive::destroyContext(ctx);
+}
+
+static void BenchStrokeDraw(const BenchConfig& cfg, const BenchShape& shape, bool invalidate, BenchResult& result)
+{
+    rive::HContext ctx             = CreateBenchContext(rive::MODE_TESSELLATION);
+    rive::SharedRenderer* renderer = CreateBenchRenderer(ctx);
+    BenchPath path;
+    path.Create(ctx, shape.m_SubPaths, shape.m_Segments);
+
+    rive::SharedRenderPaint* paint = (rive::SharedRenderPaint*) rive::createRenderPaint(ctx);
+    paint->style(rive::RenderPaintStyle::stroke);
+    paint->color(0xff00ff00);
+    paint->thickness(4.0f);
+    paint->join(rive::StrokeJoin::round);
+    paint->cap(rive::StrokeCap::round);
+
+    rive::Mat2D transform;
+    std::vector<double> samples;
+    g_BufferStats.m_UploadedBytes = 0;
+
+    for (int i = 0; i < cfg.m_Iterations; ++i)
+    {
+        // Without changes the cached stroke is drawn again without an upload
+        if (invalidate)
+        {
+            path.Invalidate();
+            paint->invalidateStroke();
+        }
+        rive::newFrame((rive::HRenderer) renderer);
+        BenchClock::time_point start = BenchClock::now();
+        paint->drawPaint(renderer, transform, (rive::SharedRenderPath*) path.m_Container);
+        samples.push_back(ElapsedMs(start));
+    }
+
+    result.m_UploadedBytes = g_BufferStats.m_UploadedBytes / cfg.m_Iterations;
+    result.m_Stats         = bench::computeStats(samples);
+
+    delete paint;
+    path.Destroy();
+    rive::destroyRenderer((rive::HRenderer) renderer);
+    rive::destroyContext(ctx);
+}
+
+static void BenchStroke(const BenchConfig& cfg, const BenchShape& shape, BenchResult& result)
+{
+    BenchStrokeDraw(cfg, shape, true, result);
+}
+
+static void BenchStrokeCached(const BenchConfig& cfg, const BenchShape& shape, BenchResult& result)
+{
+    BenchStrokeDraw(cfg, shape, false, result);
+}
+
+// Records a frame shaped like a typical artboard: a paint change every four
+// events and the world transform changing every eight draws.
+static void RecordBenchEvents(rive::SharedRenderer* renderer, int count)
+{
+    rive::PathDrawEvent evtPaint = {
+        .m_Type  = rive::EVENT_SET_PAINT,
+        .m_Paint = (rive::HRenderPaint) 0x1000,
+    };
+    rive::PathDrawEvent evtDraw = {
+        .m_Type = rive::EVENT_DRAW,
+        .m_Path = (rive::HRenderPath) 0x2000,
+    };
+    rive::Mat2D transform;
+
+    for (int j = 0; j < count; ++j)
+    {
+        if ((j % 4) == 0)
+        {
+            renderer->pushDrawEvent(evtPaint);
+        }
+        else
+        {
+            transform[4]                = (float) (j / 8);
+            evtDraw.m_TransformWorldIdx = renderer->internTransform(transform);
+            renderer->pushDrawEvent(evtDraw);
+        }
+    }
+}
+
+static void BenchRecord(const BenchConfig& cfg, int count, rive::RecordingFormat format, BenchResult& result)
+{
+    rive::HContext ctx             = CreateBenchContext(rive::MODE_TESSELLATION);
+    rive::SharedRenderer* renderer = CreateBenchRenderer(ctx);
+    rive::setRecordingFormat((rive::HRenderer) renderer, format);
+    std::vector<double> samples;
+
+    for (int i = 0; i < cfg.m_Iterations; ++i)
+    {
+        rive::newFrame((rive::HRenderer) renderer);
+        BenchClock::time_point start = BenchClock::now();
+        RecordBenchEvents(renderer, count);
+        samples.push_back(ElapsedMs(start));
+    }
+
+    result.m_Stats = bench::computeStats(samples);
+
+    rive::destroyRenderer((rive::HRenderer) renderer);
+    rive::destroyContext(ctx);
+}
+
+static void BenchPushDrawEvent(const BenchConfig& cfg, int count, BenchResult& result)
+{
+    BenchRecord(cfg, count, rive::RECORDING_FORMAT_EVENTS, result);
+}
+
+static void BenchPushDrawCommand(const BenchConfig& cfg, int count, BenchResult& result)
+{
+    BenchRecord(cfg, count, rive::RECORDING_FORMAT_COMMANDS, result);
+}
+
+// Consumes a recorded frame the way a backend would, the checksum keeps the loop alive
+static void BenchConsume(const BenchConfig& cfg, int count, rive::RecordingFormat format, BenchResult& result)
+{
+    rive::HContext ctx             = CreateBenchContext(rive::MODE_TESSELLATION);
+    rive::SharedRenderer* renderer = CreateBenchRenderer(ctx);
+    rive::setRecordingFormat((rive::HRenderer) renderer, format);
+    RecordBenchEvents(renderer, count);
+
+    std::vector<double> samples;
+    uintptr_t checksum = 0;
+
+    for (int i = 0; i < cfg.m_Iterations; ++i)
+    {
+        BenchClock::time_point start = BenchClock::now();
+        if (format == rive::RECORDING_FORMAT_COMMANDS)
+        {
+            rive::DrawCommandIterator it = rive::beginDrawCommands(rive::getDrawCommands((rive::HRenderer) renderer));
+            while (rive::nextDrawCommand(it))
+            {
+                checksum += (uintptr_t) it.m_Event.m_Path + (uintptr_t) it.m_Event.m_TransformWorldIdx;
+            }
+        }
+        else
+        {
+            const rive::DrawEventList events = rive::getDrawEvents((rive::HRenderer) renderer);
+            for (uint32_t j = 0; j < events.m_Count; ++j)
+            {
+                checksum += (uintptr_t) events.m_Events[j].m_Path + (uintptr_t) events.m_Events[j].m_TransformWorldIdx;
+            }
+        }
+        samples.push_back(ElapsedMs(start));
+    }
+
+    // Size of the recorded frame, reported in place of uploaded bytes
+    result.m_Stats         = bench::computeStats(samples);
+    result.m_UploadedBytes = format == rive::RECORDING_FORMAT_COMMANDS ?
+        rive::getDrawCommands((rive::HRenderer) renderer).m_Size :
+        count * sizeof(rive::PathDrawEvent);
+
+    if (checksum == 0)
+    {
+        printf("  (empty checksum)\n");
+    }
+
+    rive::destroyRenderer((rive::HRenderer) renderer);
+    rive::destroyContext(ctx);
+}
+
+static void BenchWalkDrawEvents(const BenchConfig& cfg, int count, BenchResult& result)
+{
+    BenchConsume(cfg, count, rive::RECORDING_FORMAT_EVENTS, result);
+}
+
+static void BenchDecodeDrawCommands(const BenchConfig& cfg, int count, BenchResult& result)
+{
+    BenchConsume(cfg, count, rive::RECORDING_FORMAT_COMMANDS, result);
+}
+
+static void BenchCompleteGradient(const BenchConfig& cfg, int count, BenchResult& result)
+{
+    rive::HContext ctx             = CreateBenchContext(rive::MODE_TESSELLATION);
+    rive::SharedRenderPaint* paint = (rive::SharedRenderPaint*) rive::createRenderPaint(ctx);
+    std::vector<double> samples;
+
+    for (int i = 0; i < cfg.m_Iterations; ++i)
+    {
+        BenchClock::time_point start = BenchClock::now();
+        paint->linearGradient(0.0f, 0.0f, 100.0f, 100.0f);
+        for (int j = 0; j < count; ++j)
+        {
+            paint->addStop(0xff000000 | (j * 0x1010), (float) j / (float) count);
+        }
+        paint->completeGradient();
+        samples.push_back(ElapsedMs(start));
+    }
+
+    result.m_Stats = bench::computeStats(samples);
+
+    delete paint;
+    rive::destroyContext(ctx);
+}
+
+static void BenchTransformVertices(const BenchConfig& cfg, int count, BenchResult& result)
+{
+    std::vector<float> vertices(count * 2);
+    std::vector<float> transformed(count * 2);
+    for (int i = 0; i < count * 2; ++i)
+    {
+        vertices[i] = (float) (i % 997) * 0.5f;
+    }
+
+    rive::Mat2D transform;
+    transform[0] = 0.8f;
+    transform[1] = 0.3f;
+    transform[2] = -0.3f;
+    transform[3] = 0.8f;
+    transform[4] = 10.0f;
+    transform[5] = 20.0f;
+
+    std::vector<double> samples;
+    for (int i = 0; i < cfg.m_Iterations; ++i)
+    {
+        float bounds[4] = { FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
+        BenchClock::time_point start = BenchClock::now();
+        rive::transformVertices(transform, &vertices[0], &transformed[0], count, bounds);
+        samples.push_back(ElapsedMs(start));
+    }
+
+    result.m_UploadedBytes = count * sizeof(float) * 2;
+    result.m_Stats         = bench::computeStats(samples);
+}
+
+struct ShapeBenchEntry
+{
+    const char*  m_Name;
+    ShapeBenchFn m_Fn;
+};
+
+struct CountBenchEntry
+{
+    const char*  m_Name;
+    CountBenchFn m_Fn;
+    int          m_Counts[4];
+};
+
+static const ShapeBenchEntry g_ShapeBenchmarks[] = {
+    { "tessellation_update",         BenchTessellation              },
+    { "tessellation_cached",         BenchTessellationCached        },
+    { "tessellation_first_subpath",  BenchTessellationFirstSubPath  },
+    { "flatten_contour",             BenchFlattenContour            },
+    { "triangulate_simple",          BenchTriangulateSimple         },
+    { "triangulate_simple_libtess2", BenchTriangulateSimpleLibtess2 },
+    { "triangulate_convex",          BenchTriangulateConvex         },
+    { "triangulate_convex_libtess2", BenchTriangulateConvexLibtess2 },
+    { "stc_stencil",                 BenchStencil                   },
+    { "stc_update_buffers",          BenchStencilUpdateBuffers      },
+    { "stroke_draw_paint",           BenchStroke                    },
+    { "stroke_draw_paint_cached",    BenchStrokeCached              },
+};
+
+// Gradient stop counts must stay below PaintData::MAX_STOPS
+static const CountBenchEntry g_CountBenchmarks[] = {
+    { "push_draw_event",      BenchPushDrawEvent,      { 100, 1000, 10000, 100000 } },
+    { "push_draw_command",    BenchPushDrawCommand,    { 100, 1000, 10000, 100000 } },
+    { "walk_draw_events",     BenchWalkDrawEvents,     { 100, 1000, 10000, 100000 } },
+    { "decode_draw_commands", BenchDecodeDrawCommands, { 100, 1000, 10000, 100000 } },
+    { "complete_gradient",    BenchCompleteGradient,   { 2, 4, 8, 15 }              },
+    { "transform_vertices",   BenchTransformVertices,  { 100, 1000, 10000, 100000 } },
+};
+
+static const int g_NumShapeBenchmarks = sizeof(g_ShapeBenchmarks) / sizeof(g_ShapeBenchmarks[0]);
+static const int g_NumCountBenchmarks = sizeof(g_CountBenchmarks) / sizeof(g_CountBenchmarks[0]);
+static const int g_NumSubPathCounts   = sizeof(g_SubPathCounts) / sizeof(g_SubPathCounts[0]);
+static const int g_NumSegmentCounts   = sizeof(g_SegmentCounts) / sizeof(g_SegmentCounts[0]);
+
+static bool WriteJsonReport(const char* path, const BenchConfig& cfg, const std::vector<BenchResult>& results)
+{
+    FILE* fp = fopen(path, "w");
+    if (fp == 0)
+    {
+        fprintf(stderr, "Failed to open '%s' for writing\n", path);
+        return false;
+    }
+
+    fprintf(fp, "{\n  \"iterations\": %d,\n  \"results\": [\n", cfg.m_Iterations);
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchResult& r = results[i];
+        fprintf(fp, "    { \"name\": \"%s\", ", r.m_Name.c_str());
+        if (r.m_Count > 0)
+        {
+            fprintf(fp, "\"count\": %d, \"bytes\": %llu, ", r.m_Count, (unsigned long long) r.m_UploadedBytes);
+        }
+        else
+        {
+            fprintf(fp, "\"subpaths\": %d, \"segments\": %d, \"vertices\": %u, \"uploaded_bytes\": %llu, ",
+                r.m_Shape.m_SubPaths, r.m_Shape.m_Segments, r.m_Shape.m_Vertices, (unsigned long long) r.m_UploadedBytes);
+        }
+        bench::writeJsonStats(fp, "time_ms", r.m_Stats);
+        fprintf(fp, " }%s\n", (i + 1) < results.size() ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+    fclose(fp);
+    return true;
+}
+
+static void PrintUsage(const char* exe)
+{
+    printf("Usage: %s [options]\n", exe);
+    printf("  --iterations N   Iterations per benchmark and case (default 200)\n");
+    printf("  --filter NAME    Only run benchmarks whose name contains NAME\n");
+    printf("  --json PATH      Write a JSON report to PATH\n");
+    printf("Benchmarks:\n");
+    for (int i = 0; i < g_NumShapeBenchmarks; ++i)
+    {
+        printf("  %s\n", g_ShapeBenchmarks[i].m_Name);
+    }
+    for (int i = 0; i < g_NumCountBenchmarks; ++i)
+    {
+        printf("  %s\n", g_CountBenchmarks[i].m_Name);
+    }
+}
+
+static bool ParseArgs(int argc, char const *argv[], BenchConfig& cfg)
+{
+    cfg.m_Iterations = 200;
+    cfg.m_JsonPath   = 0;
+    cfg.m_Filter     = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* nextArg = (i + 1) < argc ? argv[i + 1] : 0;
+        if (strcmp(argv[i], "--iterations") == 0 && nextArg)
+        {
+            cfg.m_Iterations = atoi(nextArg);
+            i++;
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && nextArg)
+        {
+            cfg.m_Filter = nextArg;
+            i++;
+        }
+        else if (strcmp(argv[i], "--json") == 0 && nextArg)
+        {
+            cfg.m_JsonPath = nextArg;
+            i++;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return cfg.m_Iterations > 0;
+}
+
+static inline bool IsFiltered(const BenchConfig& cfg, const char* name)
+{
+    return cfg.m_Filter && strstr(name, cfg.m_Filter) == 0;
+}
+
+int main(int argc, char const *argv[])
+{
+    BenchConfig cfg;
+    if (!ParseArgs(argc, argv, cfg))
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<BenchResult> results;
+    uint32_t flattenedVertices[g_NumSubPathCounts][g_NumSegmentCounts];
+
+    for (int s = 0; s < g_NumSubPathCounts; ++s)
+    {
+        for (int g = 0; g < g_NumSegmentCounts; ++g)
+        {
+            flattenedVertices[s][g] = MeasureFlattenedVertices(g_SubPathCounts[s], g_SegmentCounts[g]);
+        }
+    }
+
+    for (int b = 0; b < g_NumShapeBenchmarks; ++b)
+    {
+        const ShapeBenchEntry& entry = g_ShapeBenchmarks[b];
+        if (IsFiltered(cfg, entry.m_Name))
+        {
+            continue;
+        }
+
+        printf("%s\n", entry.m_Name);
+
+        for (int s = 0; s < g_NumSubPathCounts; ++s)
+        {
+            for (int g = 0; g < g_NumSegmentCounts; ++g)
+            {
+                BenchResult result        = {};
+                result.m_Name             = entry.m_Name;
+                result.m_Shape.m_SubPaths = g_SubPathCounts[s];
+                result.m_Shape.m_Segments = g_SegmentCounts[g];
+                result.m_Shape.m_Vertices = flattenedVertices[s][g];
+                entry.m_Fn(cfg, result.m_Shape, result);
+
+                printf("  subpaths %3d  segments %4d  vertices %7u  uploaded %9llu B  median %9.4f ms  p99 %9.4f ms\n",
+                    result.m_Shape.m_SubPaths, result.m_Shape.m_Segments, result.m_Shape.m_Vertices,
+                    (unsigned long long) result.m_UploadedBytes, result.m_Stats.m_Median, result.m_Stats.m_P99);
+
+                results.push_back(result);
+            }
+        }
+    }
+
+    for (int b = 0; b < g_NumCountBenchmarks; ++b)
+    {
+        const CountBenchEntry& entry = g_CountBenchmarks[b];
+        if (IsFiltered(cfg, entry.m_Name))
+        {
+            continue;
+        }
+
+        printf("%s\n", entry.m_Name);
+
+        for (int c = 0; c < (int) (sizeof(entry.m_Counts) / sizeof(entry.m_Counts[0])); ++c)
+        {
+            BenchResult result = {};
+            result.m_Name      = entry.m_Name;
+            result.m_Count     = entry.m_Counts[c];
+            entry.m_Fn(cfg, result.m_Count, result);
+
+            printf("  count %7d  bytes %9llu  median %9.4f ms  p99 %9.4f ms\n",
+                result.m_Count, (unsigned long long) result.m_UploadedBytes, result.m_Stats.m_Median, result.m_Stats.m_P99);
+
+            results.push_back(result);
+        }
+    }
+
+    if (cfg.m_JsonPath && !WriteJsonReport(cfg.m_JsonPath, cfg, results))
+    {
+        return 1;
+    }
+
+    return 0;
+}
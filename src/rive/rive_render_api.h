@@ -5,6 +5,7 @@ namespace rive
 {
     typedef uintptr_t    HContext;
     typedef uintptr_t    HBuffer;
+    typedef uintptr_t    HThreadPool;
     typedef RenderPaint* HRenderPaint;
     typedef RenderPath*  HRenderPath;
     typedef Renderer*    HRenderer;
@@ -17,6 +18,19 @@ namespace rive
 
     typedef HBuffer (*RequestBufferCb)(HBuffer buffer, BufferType type, void* data, unsigned int dataSize, void* userData);
     typedef void    (*DestroyBufferCb)(HBuffer buffer, void* userData);
+    typedef void    (*JobFunction)(void* jobData, uint32_t jobIndex);
+
+    // Optional job system used to prepare dirty paths in parallel. When set, dirty
+    // paths are only collected while drawing and are contoured / tessellated in endFrame.
+    // Submit runs fn(jobData, i) for every i in [0, jobCount) on any thread, wait blocks
+    // until all of them have finished. The renderer never has more than one group of
+    // jobs in flight, and buffer requests are always made on the thread calling endFrame.
+    struct JobSystem
+    {
+        void  (*m_SubmitCb)(JobFunction fn, void* jobData, uint32_t jobCount, void* userData);
+        void  (*m_WaitCb)(void* userData);
+        void* m_UserData;
+    };
 
     enum FillType
     {
@@ -32,6 +46,23 @@ namespace rive
         MODE_STENCIL_TO_COVER = 1,
     };
 
+    enum RecordingFormat
+    {
+        RECORDING_FORMAT_EVENTS   = 0,
+        RECORDING_FORMAT_COMMANDS = 1,
+    };
+
+    // EVENT_CLIPPING_BEGIN carries the world space bounds of the clip paths that follow
+    // as m_TransformWorldIdx, mapping the quad [-1, 1] onto them. It is all zero when the
+    // clipping is only being cleared. m_AppliedClipCount is the clip level the stencil
+    // is at, zero if it has to be cleared, and the clip draws first pop it down to the
+    // level in m_Idx before the remaining ones push a level each. EVENT_CLIPPING_END
+    // carries the resulting level in m_AppliedClipCount.
+    // Clip paths that are axis aligned rectangles don't go through the stencil while no
+    // instances are set, their intersection is sent with EVENT_CLIPPING_SCISSOR instead.
+    // It maps the quad onto the scissor rect the same way, and has m_IsClipping cleared
+    // when the scissor is removed. Clip path draws must not be limited by the scissor,
+    // the stencil they write outlives it.
     enum PathDrawEventType
     {
         EVENT_NONE             = 0,
@@ -43,6 +74,9 @@ namespace rive
         EVENT_CLIPPING_BEGIN   = 6,
         EVENT_CLIPPING_END     = 7,
         EVENT_CLIPPING_DISABLE = 8,
+        EVENT_DRAW_BATCH       = 9,
+        EVENT_SET_INSTANCES    = 10,
+        EVENT_CLIPPING_SCISSOR = 11,
     };
 
     struct PathDrawEvent
@@ -50,22 +84,97 @@ namespace rive
         PathDrawEventType m_Type;
         HRenderPath       m_Path;
         HRenderPaint      m_Paint;
-        Mat2D             m_TransformWorld;
-        Mat2D             m_TransformLocal;
         uint32_t          m_OffsetStart;
         uint32_t          m_OffsetEnd;
+        uint32_t          m_TransformWorldIdx;
+        uint32_t          m_TransformLocalIdx;
+        uint32_t          m_PaintId;
         uint32_t          m_Idx              : 22;
         uint32_t          m_AppliedClipCount : 8;
         uint32_t          m_IsEvenOdd        : 1;
         uint32_t          m_IsClipping       : 1;
     };
 
+    // Vertex layout of the batch buffers. Positions are already transformed to
+    // world space and the color is RGBA8 (not premultiplied). With batching enabled,
+    // endFrame must be called after drawing to close the last batch and upload it.
+    struct BatchVertex
+    {
+        float    m_X;
+        float    m_Y;
+        uint32_t m_Color;
+    };
+
+    // Batch geometry is built in endFrame, EVENT_DRAW_BATCH only references the
+    // batched meshes. getBatchRange resolves it to a range in the batch index buffer,
+    // m_IsOpaque is set if every mesh in the range is opaque.
+    struct BatchRange
+    {
+        uint32_t m_IndexStart;
+        uint32_t m_IndexCount;
+        bool     m_IsOpaque;
+    };
+
     struct DrawBuffers
     {
         HBuffer m_VertexBuffer;
         HBuffer m_IndexBuffer;
     };
 
+    // Read-only view of the events recorded for the current frame. The pointer
+    // stays valid until the next call to newFrame or any draw call on the renderer.
+    struct DrawEventList
+    {
+        const PathDrawEvent* m_Events;
+        uint32_t             m_Count;
+    };
+
+    // All transforms referenced by the draw events of the current frame, deduplicated.
+    // Events index into it with m_TransformWorldIdx / m_TransformLocalIdx, entry 0 is
+    // always the identity transform.
+    struct TransformPalette
+    {
+        const Mat2D* m_Transforms;
+        uint32_t     m_Count;
+    };
+
+    // Instance transforms of the current frame. An EVENT_SET_INSTANCES event selects
+    // the range [m_OffsetStart, m_OffsetEnd) for all draws that follow it, each draw
+    // is then repeated once per instance with the instance transform applied in world space.
+    // Each draw covers all instances before the next draw starts, so instances must not
+    // overlap: blending would interleave them, and in stencil to cover mode the windings
+    // of overlapping instances add up in the stencil.
+    struct InstanceList
+    {
+        const Mat2D* m_Transforms;
+        uint32_t     m_Count;
+    };
+
+    // Packed variable length command stream, used with RECORDING_FORMAT_COMMANDS.
+    // Each command is a header byte followed by the payload for its type, transform
+    // palette indices are only stored when they differ from the previous draw command.
+    // Apart from the palette, the data has no references into the renderer, so a
+    // stream can be copied together with its palette and decoded anywhere.
+    struct DrawCommandStream
+    {
+        const uint8_t* m_Data;
+        const Mat2D*   m_Transforms;
+        uint32_t       m_Size;
+        uint32_t       m_Count;
+        uint32_t       m_TransformCount;
+    };
+
+    // Decodes a command stream into m_Event. Fields that are not part of a command
+    // are zeroed, except the transform indices which persist from the last draw command.
+    struct DrawCommandIterator
+    {
+        const uint8_t* m_Cursor;
+        const uint8_t* m_End;
+        PathDrawEvent  m_Event;
+    };
+
+    // m_IsOpaque is set when the color or every gradient stop is fully opaque, so
+    // draws with the paint hide everything behind them.
     struct PaintData
     {
         static const int MAX_STOPS = 16;
@@ -74,9 +183,10 @@ namespace rive
         float        m_Stops[MAX_STOPS];
         float        m_Colors[MAX_STOPS * 4];
         float        m_GradientLimits[4];
+        bool         m_IsOpaque;
     };
 
-    HContext            createContext();
+    HContext            createContext(const JobSystem* jobSystem = 0);
     void                destroyContext(HContext ctx);
     RenderMode          getRenderMode(HContext ctx);
     void                setBufferCallbacks(HContext ctx, RequestBufferCb rcb, DestroyBufferCb dcb, void* userData = 0);
@@ -84,20 +194,85 @@ namespace rive
     RenderPath*         createRenderPath(HContext ctx);
     RenderPaint*        createRenderPaint(HContext ctx);
 
+    // Tessellated fills are shared between all paths of the context that flatten to the
+    // same contours and fill rule, e.g clones of an artboard. Enabled by default.
+    void                setGeometryCaching(HContext ctx, bool state);
+    bool                getGeometryCaching(HContext ctx);
+
     HRenderer           createRenderer(HContext ctx);
     void                destroyRenderer(HRenderer renderer);
-    void                newFrame(HRenderer renderer);
-    void                resetClipping(HRenderer renderer);
+
+    // Fills are flattened to within the contour error, in pixels on screen. The contour
+    // scale is the number of pixels per unit of the renderer's transform, e.g the camera zoom.
     void                setContourQuality(HRenderer renderer, float quality);
+    void                setContourScale(HRenderer renderer, float scale);
+    float               getContourError(HRenderer renderer);
+
+    // Draws whose bounds miss the cull rect are dropped while recording. The rect is in
+    // world space, and draws are only dropped if they miss it with every instance. Path
+    // bounds are those of the control points, grown by the stroke thickness for strokes.
+    // isCulled tests a rect in the space of the current transform, e.g an artboard's
+    // bounds, so whole subtrees can be skipped before they are drawn.
+    void                setCullRect(HRenderer renderer, float minX, float minY, float maxX, float maxY);
+    void                clearCullRect(HRenderer renderer);
+    bool                isCulled(HRenderer renderer, float minX, float minY, float maxX, float maxY);
+
+    // Command lists are renderers that only record, with their own transform and clip
+    // stacks. Each list can be recorded on its own thread, and lists are merged into
+    // their renderer in the order appendCommandList is called, on the renderer's thread.
+    // Call newFrame on a list before recording, it picks up the renderer's settings.
+    // Lists start without clips or instances, appending one resets both on the renderer
+    // before its draws, and the renderer continues with the state the list ended in.
+    // A path or paint may only be drawn into one list per frame, since buffer updates
+    // are deferred until the list has been appended. newFrame on a list never updates
+    // buffers, a list that wasn't appended drops them and they are redone on the next draw.
+    HRenderer           createCommandList(HRenderer renderer);
+    void                appendCommandList(HRenderer renderer, HRenderer commandList);
+    void                newFrame(HRenderer renderer);
+    void                endFrame(HRenderer renderer);
+    void                reserveDrawEvents(HRenderer renderer, uint32_t count);
+    void                setRecordingFormat(HRenderer renderer, RecordingFormat format);
+    RecordingFormat     getRecordingFormat(HRenderer renderer);
     void                setClippingSupport(HRenderer renderer, bool state);
+
+    // With clip retention the clips applied at the end of a frame are assumed to still be
+    // in the stencil buffer at the start of the next, and are not drawn again if the clip
+    // paths haven't changed. The stencil buffer must be kept between frames, and
+    // resetClipping called after newFrame whenever it isn't, e.g when the view changed.
+    void                setClipRetention(HRenderer renderer, bool state);
+    bool                getClipRetention(HRenderer renderer);
+    void                resetClipping(HRenderer renderer);
+
+    void                setBatchingSupport(HRenderer renderer, bool state);
     void                setTransform(HRenderer renderer, const Mat2D& transform);
+
+    // Every following draw is repeated for each instance transform, see InstanceList.
+    // Only for instances that don't overlap on screen, e.g clones laid out side by side.
+    // Rect clips are only sent as a scissor while no instances are set, so instances must
+    // not be set while a rect clip is active, e.g inside a save that clipped to a rect.
+    void                setInstances(HRenderer renderer, const Mat2D* transforms, uint32_t count);
     bool                getClippingSupport(HRenderer renderer);
-    float               getContourError(HRenderer renderer);
+    bool                getBatchingSupport(HRenderer renderer);
     uint32_t            getDrawEventCount(HRenderer renderer);
     const DrawBuffers   getDrawBuffers(HContext ctx, HRenderer renderer, HRenderPath path);
-    const DrawBuffers   getDrawBuffers(HContext ctx, HRenderer renderer, HRenderPaint paint);
+    const DrawBuffers   getStrokeDrawBuffers(HRenderer renderer, const PathDrawEvent& evt);
+    const DrawBuffers   getBatchDrawBuffers(HRenderer renderer);
+    const BatchRange    getBatchRange(HRenderer renderer, const PathDrawEvent& evt);
     const PathDrawEvent getDrawEvent(HRenderer renderer, uint32_t i);
+    const DrawEventList getDrawEvents(HRenderer renderer);
+    const DrawCommandStream getDrawCommands(HRenderer renderer);
+    const TransformPalette getTransformPalette(HRenderer renderer);
+    const InstanceList  getInstances(HRenderer renderer);
+    DrawCommandIterator beginDrawCommands(const DrawCommandStream& stream);
+    bool                nextDrawCommand(DrawCommandIterator& it);
     const PaintData     getPaintData(HRenderPaint paint);
+    const PaintData*    getPaintData(HRenderer renderer, uint32_t paintId);
+
+    // Built-in job system, a fixed set of worker threads that the submitting thread
+    // helps out while waiting. Zero threads means one less than the number of cores.
+    HThreadPool         createThreadPool(uint32_t threadCount = 0);
+    void                destroyThreadPool(HThreadPool pool);
+    const JobSystem     getJobSystem(HThreadPool pool);
 }
 
 #endif /* _RIVE_RENDER_API_H_ */
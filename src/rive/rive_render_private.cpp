@@ -1,8 +1,17 @@
 #include <float.h>
+#include <math.h>
 #include <string.h>
 
+#include <unordered_map>
+
 #include <jc/array.h>
 
+#if defined(__AVX__)
+    #include <immintrin.h>
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
 #include <rive/artboard.hpp>
 #include <rive/contour_render_path.hpp>
 #include <rive/contour_stroke.hpp>
@@ -24,6 +33,595 @@ namespace rive
         rgbaOut[3] = (float)((0xff000000 & colorIn) >> 24) / 255.0f;
     }
 
+    static inline uint32_t packColor(const float* rgba)
+    {
+        return ((uint32_t) (rgba[0] * 255.0f + 0.5f))       |
+               ((uint32_t) (rgba[1] * 255.0f + 0.5f)) << 8  |
+               ((uint32_t) (rgba[2] * 255.0f + 0.5f)) << 16 |
+               ((uint32_t) (rgba[3] * 255.0f + 0.5f)) << 24;
+    }
+
+    static inline uint32_t hashBytes(uint32_t hash, const void* data, size_t size)
+    {
+        // FNV-1a
+        const uint8_t* bytes = (const uint8_t*) data;
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    // Only the stops and colors that are in use take part in the hash / compare,
+    // the rest of the paint data is always zeroed when the paint is (re)built.
+    static uint32_t hashPaintData(const PaintData& pd)
+    {
+        uint32_t hash = 2166136261u;
+        hash = hashBytes(hash, &pd.m_FillType, sizeof(pd.m_FillType));
+        hash = hashBytes(hash, &pd.m_StopCount, sizeof(pd.m_StopCount));
+        hash = hashBytes(hash, pd.m_Stops, pd.m_StopCount * sizeof(float));
+        hash = hashBytes(hash, pd.m_Colors, pd.m_StopCount * 4 * sizeof(float));
+        hash = hashBytes(hash, pd.m_GradientLimits, sizeof(pd.m_GradientLimits));
+        return hash;
+    }
+
+    static bool paintDataEquals(const PaintData& a, const PaintData& b)
+    {
+        return a.m_FillType  == b.m_FillType
+            && a.m_StopCount == b.m_StopCount
+            && memcmp(a.m_Stops, b.m_Stops, a.m_StopCount * sizeof(float)) == 0
+            && memcmp(a.m_Colors, b.m_Colors, a.m_StopCount * 4 * sizeof(float)) == 0
+            && memcmp(a.m_GradientLimits, b.m_GradientLimits, sizeof(a.m_GradientLimits)) == 0;
+    }
+
+    ////////////////////////////////////////////////////////
+    // Vertex transform
+    ////////////////////////////////////////////////////////
+
+    // Vertices are interleaved xy pairs, so with the pair swapped in a second register
+    // x' = m0*x + m2*y + m4 and y' = m3*y + m1*x + m5 are two multiplies and adds for
+    // every lane. Lanes 0 and 2 of the min / max registers hold x, 1 and 3 hold y.
+    void transformVertices(const Mat2D& m, const float* in, float* out, uint32_t count, float* bounds)
+    {
+        float minX = FLT_MAX;
+        float minY = FLT_MAX;
+        float maxX = -FLT_MAX;
+        float maxY = -FLT_MAX;
+        uint32_t i = 0;
+
+#if defined(__AVX__) || defined(__SSE2__)
+        __m128 minV = _mm_set1_ps(FLT_MAX);
+        __m128 maxV = _mm_set1_ps(-FLT_MAX);
+        const __m128 a = _mm_setr_ps(m[0], m[3], m[0], m[3]);
+        const __m128 b = _mm_setr_ps(m[2], m[1], m[2], m[1]);
+        const __m128 t = _mm_setr_ps(m[4], m[5], m[4], m[5]);
+
+    #if defined(__AVX__)
+        const __m256 a8 = _mm256_set_m128(a, a);
+        const __m256 b8 = _mm256_set_m128(b, b);
+        const __m256 t8 = _mm256_set_m128(t, t);
+        __m256 minV8    = _mm256_set1_ps(FLT_MAX);
+        __m256 maxV8    = _mm256_set1_ps(-FLT_MAX);
+
+        for (; i + 4 <= count; i += 4)
+        {
+            __m256 v = _mm256_loadu_ps(in + i * 2);
+            __m256 s = _mm256_permute_ps(v, _MM_SHUFFLE(2, 3, 0, 1));
+            __m256 r = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(v, a8), _mm256_mul_ps(s, b8)), t8);
+            _mm256_storeu_ps(out + i * 2, r);
+            minV8 = _mm256_min_ps(minV8, r);
+            maxV8 = _mm256_max_ps(maxV8, r);
+        }
+
+        minV = _mm_min_ps(_mm256_castps256_ps128(minV8), _mm256_extractf128_ps(minV8, 1));
+        maxV = _mm_max_ps(_mm256_castps256_ps128(maxV8), _mm256_extractf128_ps(maxV8, 1));
+    #endif
+
+        for (; i + 2 <= count; i += 2)
+        {
+            __m128 v = _mm_loadu_ps(in + i * 2);
+            __m128 s = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+            __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(v, a), _mm_mul_ps(s, b)), t);
+            _mm_storeu_ps(out + i * 2, r);
+            minV = _mm_min_ps(minV, r);
+            maxV = _mm_max_ps(maxV, r);
+        }
+
+        float lanes[4];
+        _mm_storeu_ps(lanes, _mm_min_ps(minV, _mm_movehl_ps(minV, minV)));
+        minX = lanes[0];
+        minY = lanes[1];
+        _mm_storeu_ps(lanes, _mm_max_ps(maxV, _mm_movehl_ps(maxV, maxV)));
+        maxX = lanes[0];
+        maxY = lanes[1];
+#endif
+
+        const float m0 = m[0];
+        const float m1 = m[1];
+        const float m2 = m[2];
+        const float m3 = m[3];
+        const float m4 = m[4];
+        const float m5 = m[5];
+
+        for (; i < count; ++i)
+        {
+            float x      = in[i*2];
+            float y      = in[i*2 + 1];
+            float tx     = m0 * x + m2 * y + m4;
+            float ty     = m1 * x + m3 * y + m5;
+            out[i*2    ] = tx;
+            out[i*2 + 1] = ty;
+            minX         = fminf(minX, tx);
+            minY         = fminf(minY, ty);
+            maxX         = fmaxf(maxX, tx);
+            maxY         = fmaxf(maxY, ty);
+        }
+
+        if (bounds)
+        {
+            bounds[0] = fminf(bounds[0], minX);
+            bounds[1] = fminf(bounds[1], minY);
+            bounds[2] = fmaxf(bounds[2], maxX);
+            bounds[3] = fmaxf(bounds[3], maxY);
+        }
+    }
+
+    ////////////////////////////////////////////////////////
+    // Contour flattening
+    ////////////////////////////////////////////////////////
+
+    static const uint32_t CUBIC_MAX_SEGMENTS = 128;
+
+    // Per-thread list of the cubics in the path being flattened, as p0..p3
+    static thread_local jc::Array<float>    g_FlattenCubics;
+    static thread_local jc::Array<uint32_t> g_FlattenSegments;
+
+    // Wang's formula: a cubic split into n uniform steps stays within 'tolerance' of the
+    // curve when n >= sqrt(3/4 * max(|p0 - 2p1 + p2|, |p1 - 2p2 + p3|) / tolerance).
+    static void computeCubicSegments(const float* cubics, uint32_t count, float tolerance, uint32_t* segments)
+    {
+        const float k = 0.75f / tolerance;
+        uint32_t i    = 0;
+
+#if defined(__SSE2__)
+        const __m128 two = _mm_set1_ps(2.0f);
+        const __m128 kv  = _mm_set1_ps(k);
+
+        for (; i + 4 <= count; i += 4)
+        {
+            const float* c0 = &cubics[(i    ) * 8];
+            const float* c1 = &cubics[(i + 1) * 8];
+            const float* c2 = &cubics[(i + 2) * 8];
+            const float* c3 = &cubics[(i + 3) * 8];
+
+            __m128 p[8];
+            for (int j = 0; j < 8; ++j)
+            {
+                p[j] = _mm_setr_ps(c0[j], c1[j], c2[j], c3[j]);
+            }
+
+            __m128 ax = _mm_add_ps(_mm_sub_ps(p[0], _mm_mul_ps(two, p[2])), p[4]);
+            __m128 ay = _mm_add_ps(_mm_sub_ps(p[1], _mm_mul_ps(two, p[3])), p[5]);
+            __m128 bx = _mm_add_ps(_mm_sub_ps(p[2], _mm_mul_ps(two, p[4])), p[6]);
+            __m128 by = _mm_add_ps(_mm_sub_ps(p[3], _mm_mul_ps(two, p[5])), p[7]);
+            __m128 lenSq = _mm_max_ps(_mm_add_ps(_mm_mul_ps(ax, ax), _mm_mul_ps(ay, ay)),
+                                      _mm_add_ps(_mm_mul_ps(bx, bx), _mm_mul_ps(by, by)));
+
+            float n[4];
+            _mm_storeu_ps(n, _mm_sqrt_ps(_mm_mul_ps(kv, _mm_sqrt_ps(lenSq))));
+
+            for (int j = 0; j < 4; ++j)
+            {
+                float nj        = ceilf(n[j]);
+                segments[i + j] = nj < 1.0f ? 1 : (nj > (float) CUBIC_MAX_SEGMENTS ? CUBIC_MAX_SEGMENTS : (uint32_t) nj);
+            }
+        }
+#endif
+
+        for (; i < count; ++i)
+        {
+            const float* c = &cubics[i * 8];
+            float ax       = c[0] - 2.0f * c[2] + c[4];
+            float ay       = c[1] - 2.0f * c[3] + c[5];
+            float bx       = c[2] - 2.0f * c[4] + c[6];
+            float by       = c[3] - 2.0f * c[5] + c[7];
+            float lenSq    = fmaxf(ax * ax + ay * ay, bx * bx + by * by);
+            float n        = ceilf(sqrtf(k * sqrtf(lenSq)));
+            segments[i]    = n < 1.0f ? 1 : (n > (float) CUBIC_MAX_SEGMENTS ? CUBIC_MAX_SEGMENTS : (uint32_t) n);
+        }
+    }
+
+    // Writes the points at t = 1/n .. (n-1)/n, the end point is added by the caller
+    static float* evaluateCubic(const float* c, uint32_t n, float* out)
+    {
+        // p(t) = ((a * t + b) * t + c) * t + p0
+        const float ax = c[6] - c[0] + 3.0f * (c[2] - c[4]);
+        const float ay = c[7] - c[1] + 3.0f * (c[3] - c[5]);
+        const float bx = 3.0f * (c[0] - 2.0f * c[2] + c[4]);
+        const float by = 3.0f * (c[1] - 2.0f * c[3] + c[5]);
+        const float cx = 3.0f * (c[2] - c[0]);
+        const float cy = 3.0f * (c[3] - c[1]);
+        const float dt = 1.0f / (float) n;
+        uint32_t i     = 1;
+
+#if defined(__SSE2__)
+        const __m128 axv = _mm_set1_ps(ax);
+        const __m128 ayv = _mm_set1_ps(ay);
+        const __m128 bxv = _mm_set1_ps(bx);
+        const __m128 byv = _mm_set1_ps(by);
+        const __m128 cxv = _mm_set1_ps(cx);
+        const __m128 cyv = _mm_set1_ps(cy);
+        const __m128 dxv = _mm_set1_ps(c[0]);
+        const __m128 dyv = _mm_set1_ps(c[1]);
+        const __m128 dtv = _mm_set1_ps(dt);
+
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128 t = _mm_mul_ps(_mm_setr_ps((float) i, (float) (i + 1), (float) (i + 2), (float) (i + 3)), dtv);
+            __m128 x = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(axv, t), bxv), t), cxv), t), dxv);
+            __m128 y = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(ayv, t), byv), t), cyv), t), dyv);
+            _mm_storeu_ps(out,     _mm_unpacklo_ps(x, y));
+            _mm_storeu_ps(out + 4, _mm_unpackhi_ps(x, y));
+            out += 8;
+        }
+#endif
+
+        for (; i < n; ++i)
+        {
+            float t = (float) i * dt;
+            *out++  = ((ax * t + bx) * t + cx) * t + c[0];
+            *out++  = ((ay * t + by) * t + cy) * t + c[1];
+        }
+        return out;
+    }
+
+    static inline float* closeSubPath(const float* start, float* out)
+    {
+        if (start && (out[-2] != start[0] || out[-1] != start[1]))
+        {
+            out[0] = start[0];
+            out[1] = start[1];
+            out += 2;
+        }
+        return out;
+    }
+
+    // Flattens the path commands into one polyline, laid out like the runtime contour:
+    // the four corners of the bounds first, then the vertices. Every subpath is closed
+    // by repeating its first vertex. Tolerance is the max distance to the curve.
+    void flattenContour(const uint8_t* verbs, uint32_t verbCount, const float* points, float tolerance, jc::Array<float>& contour)
+    {
+        // First pass finds the cubics so that their segment counts can be computed together
+        jc::Array<float>& cubics      = g_FlattenCubics;
+        jc::Array<uint32_t>& segments = g_FlattenSegments;
+        cubics.SetSize(0);
+
+        float penX            = 0.0f;
+        float penY            = 0.0f;
+        float startX          = 0.0f;
+        float startY          = 0.0f;
+        uint32_t vertexCount  = 4;
+        const float* p        = points;
+
+        for (uint32_t i = 0; i < verbCount; ++i)
+        {
+            switch (verbs[i])
+            {
+                case PATH_VERB_MOVE:
+                    startX = penX = p[0];
+                    startY = penY = p[1];
+                    vertexCount += 2;
+                    p += 2;
+                    break;
+                case PATH_VERB_LINE:
+                    penX = p[0];
+                    penY = p[1];
+                    vertexCount++;
+                    p += 2;
+                    break;
+                case PATH_VERB_CUBIC:
+                    ensureCapacity(cubics, cubics.Size() + 8);
+                    cubics.Push(penX);
+                    cubics.Push(penY);
+                    for (int j = 0; j < 6; ++j)
+                    {
+                        cubics.Push(p[j]);
+                    }
+                    penX = p[4];
+                    penY = p[5];
+                    p += 6;
+                    break;
+                case PATH_VERB_CLOSE:
+                    penX = startX;
+                    penY = startY;
+                    vertexCount++;
+                    break;
+                default:break;
+            }
+        }
+
+        const uint32_t cubicCount = cubics.Size() / 8;
+        ensureCapacity(segments, cubicCount);
+        segments.SetSize(cubicCount);
+        computeCubicSegments(cubics.Begin(), cubicCount, tolerance, segments.Begin());
+
+        for (uint32_t i = 0; i < cubicCount; ++i)
+        {
+            vertexCount += segments[i];
+        }
+
+        // Second pass writes the vertices, moves and closes were counted twice above
+        // to leave room for the closing vertices
+        contour.SetSize(0);
+        ensureCapacity(contour, vertexCount * 2);
+
+        float* out         = contour.Begin() + 8;
+        const float* start = 0;
+        uint32_t cubic     = 0;
+        p                  = points;
+
+        for (uint32_t i = 0; i < verbCount; ++i)
+        {
+            switch (verbs[i])
+            {
+                case PATH_VERB_MOVE:
+                    out    = closeSubPath(start, out);
+                    start  = out;
+                    out[0] = p[0];
+                    out[1] = p[1];
+                    out += 2;
+                    p   += 2;
+                    break;
+                case PATH_VERB_LINE:
+                    out[0] = p[0];
+                    out[1] = p[1];
+                    out += 2;
+                    p   += 2;
+                    break;
+                case PATH_VERB_CUBIC:
+                    out    = evaluateCubic(&cubics[cubic * 8], segments[cubic], out);
+                    out[0] = p[4];
+                    out[1] = p[5];
+                    out += 2;
+                    p   += 6;
+                    cubic++;
+                    break;
+                case PATH_VERB_CLOSE:
+                    out = closeSubPath(start, out);
+                    break;
+                default:break;
+            }
+        }
+
+        out = closeSubPath(start, out);
+
+        float* v      = contour.Begin();
+        uint32_t size = (uint32_t) (out - v);
+        float minX    = size > 8 ? FLT_MAX : 0.0f;
+        float minY    = size > 8 ? FLT_MAX : 0.0f;
+        float maxX    = size > 8 ? -FLT_MAX : 0.0f;
+        float maxY    = size > 8 ? -FLT_MAX : 0.0f;
+
+        for (uint32_t i = 8; i < size; i += 2)
+        {
+            minX = v[i]     < minX ? v[i]     : minX;
+            minY = v[i + 1] < minY ? v[i + 1] : minY;
+            maxX = v[i]     > maxX ? v[i]     : maxX;
+            maxY = v[i + 1] > maxY ? v[i + 1] : maxY;
+        }
+
+        v[0] = minX; v[1] = minY;
+        v[2] = maxX; v[3] = minY;
+        v[4] = maxX; v[5] = maxY;
+        v[6] = minX; v[7] = maxY;
+        contour.SetSize(size);
+    }
+
+    ////////////////////////////////////////////////////////
+    // Geometry cache
+    ////////////////////////////////////////////////////////
+
+    struct GeometryCache
+    {
+        std::unordered_map<uint32_t, GeometryCacheEntry*> m_Entries;
+        bool                                              m_IsEnabled;
+    };
+
+    static bool geometryKeyEquals(const jc::Array<float>& a, const jc::Array<float>& b)
+    {
+        return a.Size() == b.Size() && memcmp(a.Begin(), b.Begin(), a.Size() * sizeof(float)) == 0;
+    }
+
+    static void unlinkGeometry(Context* ctx, GeometryCacheEntry* entry)
+    {
+        if (entry->m_IsCached)
+        {
+            ctx->m_GeometryCache->m_Entries.erase(entry->m_Hash);
+            entry->m_IsCached = false;
+        }
+    }
+
+    static void destroyGeometry(Context* ctx, GeometryCacheEntry* entry)
+    {
+        ctx->m_DestroyBufferCb(entry->m_VertexBuffer, ctx->m_BufferCbUserData);
+        ctx->m_DestroyBufferCb(entry->m_IndexBuffer, ctx->m_BufferCbUserData);
+        delete entry;
+    }
+
+    uint32_t hashGeometryKey(const jc::Array<float>& key)
+    {
+        return hashBytes(2166136261u, key.Begin(), key.Size() * sizeof(float));
+    }
+
+    GeometryCacheEntry* acquireGeometry(Context* ctx, GeometryCacheEntry* previous,
+        const jc::Array<float>& key, uint32_t hash, bool& needsBuild)
+    {
+        GeometryCache* cache = ctx->m_GeometryCache;
+        bool isSlotFree      = cache->m_IsEnabled;
+
+        if (cache->m_IsEnabled)
+        {
+            auto it = cache->m_Entries.find(hash);
+            if (it != cache->m_Entries.end())
+            {
+                if (geometryKeyEquals(it->second->m_Key, key))
+                {
+                    GeometryCacheEntry* entry = it->second;
+                    entry->m_RefCount++;
+                    releaseGeometry(ctx, previous);
+                    needsBuild = false;
+                    return entry;
+                }
+                isSlotFree = it->second == previous && previous->m_RefCount == 1;
+            }
+        }
+
+        // Nobody else uses the previous geometry, so it is rebuilt in place to keep its buffers
+        GeometryCacheEntry* entry = previous;
+        if (entry && entry->m_RefCount == 1)
+        {
+            unlinkGeometry(ctx, entry);
+        }
+        else
+        {
+            releaseGeometry(ctx, previous);
+            entry                 = new GeometryCacheEntry;
+            entry->m_VertexBuffer = 0;
+            entry->m_IndexBuffer  = 0;
+            entry->m_RefCount     = 1;
+            entry->m_IsCached     = false;
+        }
+
+        entry->m_Key.SetSize(0);
+        ensureCapacity(entry->m_Key, key.Size());
+        memcpy(entry->m_Key.Begin(), key.Begin(), key.Size() * sizeof(float));
+        entry->m_Key.SetSize(key.Size());
+        entry->m_Hash       = hash;
+        entry->m_IsUploaded = false;
+
+        if (isSlotFree)
+        {
+            cache->m_Entries[hash] = entry;
+            entry->m_IsCached      = true;
+        }
+
+        needsBuild = true;
+        return entry;
+    }
+
+    void releaseGeometry(Context* ctx, GeometryCacheEntry* entry)
+    {
+        if (entry == 0 || --entry->m_RefCount > 0)
+        {
+            return;
+        }
+
+        unlinkGeometry(ctx, entry);
+        destroyGeometry(ctx, entry);
+    }
+
+    ////////////////////////////////////////////////////////
+    // Draw command stream encoding
+    ////////////////////////////////////////////////////////
+
+    enum DrawCommandField
+    {
+        COMMAND_FIELD_PATH       = 1 << 0,
+        COMMAND_FIELD_PAINT      = 1 << 1,
+        COMMAND_FIELD_TRANSFORMS = 1 << 2,
+        COMMAND_FIELD_OFFSETS    = 1 << 3,
+        COMMAND_FIELD_IDX        = 1 << 4,
+        COMMAND_FIELD_CLIP_COUNT = 1 << 5,
+    };
+
+    static const uint8_t COMMAND_HEADER_TYPE_MASK       = 0x0f;
+    static const uint8_t COMMAND_HEADER_WORLD_TRANSFORM = 1 << 4;
+    static const uint8_t COMMAND_HEADER_LOCAL_TRANSFORM = 1 << 5;
+    static const uint8_t COMMAND_HEADER_EVEN_ODD        = 1 << 6;
+    static const uint8_t COMMAND_HEADER_CLIPPING        = 1 << 7;
+
+    // Header, path + paint, six varints and the clip count
+    static const uint32_t COMMAND_MAX_SIZE = 1 + 2 * sizeof(uintptr_t) + 6 * 5 + 1;
+
+    // Payload per event type, indexed by PathDrawEventType
+    static const uint8_t g_CommandFields[] = {
+        0,                                                                                         // EVENT_NONE
+        COMMAND_FIELD_PATH | COMMAND_FIELD_TRANSFORMS,                                             // EVENT_DRAW
+        COMMAND_FIELD_PATH | COMMAND_FIELD_TRANSFORMS | COMMAND_FIELD_IDX,                         // EVENT_DRAW_STENCIL
+        COMMAND_FIELD_PATH | COMMAND_FIELD_TRANSFORMS,                                             // EVENT_DRAW_COVER
+        COMMAND_FIELD_PATH | COMMAND_FIELD_TRANSFORMS | COMMAND_FIELD_OFFSETS | COMMAND_FIELD_IDX, // EVENT_DRAW_STROKE
+        COMMAND_FIELD_PAINT,                                                                       // EVENT_SET_PAINT
+        COMMAND_FIELD_TRANSFORMS | COMMAND_FIELD_IDX | COMMAND_FIELD_CLIP_COUNT,                    // EVENT_CLIPPING_BEGIN
+        COMMAND_FIELD_CLIP_COUNT,                                                                  // EVENT_CLIPPING_END
+        0,                                                                                         // EVENT_CLIPPING_DISABLE
+        COMMAND_FIELD_OFFSETS,                                                                     // EVENT_DRAW_BATCH
+        COMMAND_FIELD_OFFSETS,                                                                     // EVENT_SET_INSTANCES
+        COMMAND_FIELD_TRANSFORMS,                                                                  // EVENT_CLIPPING_SCISSOR
+    };
+
+    static inline void writeVarint(uint8_t*& p, uint32_t v)
+    {
+        while (v >= 0x80)
+        {
+            *p++ = (uint8_t) (v | 0x80);
+            v >>= 7;
+        }
+        *p++ = (uint8_t) v;
+    }
+
+    static inline uint32_t readVarint(const uint8_t*& p)
+    {
+        uint32_t v     = 0;
+        uint32_t shift = 0;
+        while (*p & 0x80)
+        {
+            v     |= (uint32_t) (*p++ & 0x7f) << shift;
+            shift += 7;
+        }
+        return v | ((uint32_t) *p++ << shift);
+    }
+
+    static inline void writePointer(uint8_t*& p, const void* ptr)
+    {
+        memcpy(p, &ptr, sizeof(ptr));
+        p += sizeof(ptr);
+    }
+
+    static inline void* readPointer(const uint8_t*& p)
+    {
+        void* ptr;
+        memcpy(&ptr, p, sizeof(ptr));
+        p += sizeof(ptr);
+        return ptr;
+    }
+
+    static inline bool eventHasTransforms(PathDrawEventType type)
+    {
+        return g_CommandFields[type] & COMMAND_FIELD_TRANSFORMS;
+    }
+
+    static inline uint32_t hashTransform(const Mat2D& m)
+    {
+        // FNV-1a over the raw float bits
+        uint32_t hash = 2166136261u;
+        for (int i = 0; i < 6; ++i)
+        {
+            uint32_t bits;
+            memcpy(&bits, &m[i], sizeof(bits));
+            hash = (hash ^ bits) * 16777619u;
+        }
+        return hash ^ (hash >> 16);
+    }
+
+    static inline uint32_t hashClipPath(uint32_t hash, const RenderPath* path, uint32_t version, const Mat2D& m)
+    {
+        const uintptr_t pathBits = (uintptr_t) path;
+        hash = (hash ^ (uint32_t) pathBits) * 16777619u;
+        hash = (hash ^ (uint32_t) ((uint64_t) pathBits >> 32)) * 16777619u;
+        hash = (hash ^ version) * 16777619u;
+        return (hash ^ hashTransform(m)) * 16777619u;
+    }
+
     ////////////////////////////////////////////////////////
     // SharedRenderPaint
     ////////////////////////////////////////////////////////
@@ -31,19 +629,18 @@ namespace rive
     SharedRenderPaint::SharedRenderPaint(Context* ctx)
     : m_Context(ctx)
     , m_Builder(0)
-    , m_Stroke(0)
-    , m_StrokeBuffer(0)
     , m_Data({})
-    {}
+    , m_Style(RenderPaintStyle::fill)
+    , m_StrokeThickness(1.0f)
+    , m_StrokeJoin(StrokeJoin::miter)
+    , m_StrokeCap(StrokeCap::butt)
+    {
+        m_DataHash = hashPaintData(m_Data);
+    }
 
     SharedRenderPaint::~SharedRenderPaint()
     {
         delete m_Builder;
-        delete m_Stroke;
-        if (m_StrokeBuffer)
-        {
-            m_Context->m_DestroyBufferCb(m_StrokeBuffer, m_Context->m_BufferCbUserData);
-        }
     }
 
 
@@ -75,56 +672,52 @@ namespace rive
     void SharedRenderPaint::style(RenderPaintStyle value)
     {
         m_Style = value;
-        delete m_Stroke;
-
-        if (m_Style == RenderPaintStyle::stroke)
-        {
-            m_Stroke = new ContourStroke();
-            m_StrokeDirty = true;
-        }
-        else
-        {
-            m_Stroke = 0;
-            m_StrokeDirty = false;
-        }
     }
 
+    // Strokes are cached on the path they are drawn with and extruded again when the
+    // path or the stroke parameters change, so there is nothing to invalidate here
     void SharedRenderPaint::invalidateStroke()
-    {
-        if (m_Stroke != 0)
-        {
-            m_StrokeDirty = true;
-        }
-    }
+    {}
 
     void SharedRenderPaint::drawPaint(SharedRenderer* renderer, const Mat2D& transform, SharedRenderPath* path)
     {
-        if (m_Stroke != 0)
+        if (m_Style == RenderPaintStyle::stroke)
         {
-            if (m_StrokeDirty)
+            uint32_t strokeIdx       = path->acquireStroke(m_StrokeThickness, m_StrokeJoin, m_StrokeCap);
+            StrokeCacheEntry* stroke = &path->m_Strokes[strokeIdx];
+            if (stroke->m_Stroke->triangleStrip().size() == 0)
             {
-                static Mat2D identity;
-                m_Stroke->reset();
-                path->extrudeStroke(m_Stroke,
-                                    m_StrokeJoin,
-                                    m_StrokeCap,
-                                    m_StrokeThickness / 2.0f,
-                                    identity);
-                m_StrokeDirty = false;
+                return;
             }
-            const std::vector<Vec2D>& strip = m_Stroke->triangleStrip();
-            size_t size = strip.size();
-            if (size == 0)
+
+            if (!stroke->m_IsUploaded)
             {
-                return;
+                if (renderer->m_Parent)
+                {
+                    renderer->queueStroke(path, strokeIdx);
+                }
+                else
+                {
+                    uploadStroke(m_Context, stroke);
+                }
             }
 
-            m_StrokeBuffer = renderer->m_Context->m_RequestBufferCb(m_StrokeBuffer, BUFFER_TYPE_VERTEX_BUFFER,
-                (void*) &strip[0][0], size * 2 * sizeof(float), renderer->m_Context->m_BufferCbUserData);
+            stroke->m_Stroke->resetRenderOffset();
+            path->renderStroke(renderer, this, path, strokeIdx, transform);
+        }
+    }
 
-            m_Stroke->resetRenderOffset();
-            path->renderStroke(renderer, this, transform);
+    void uploadStroke(Context* ctx, StrokeCacheEntry* stroke)
+    {
+        if (stroke->m_IsUploaded)
+        {
+            return;
         }
+
+        const std::vector<Vec2D>& strip = stroke->m_Stroke->triangleStrip();
+        stroke->m_Buffer = ctx->m_RequestBufferCb(stroke->m_Buffer, BUFFER_TYPE_VERTEX_BUFFER,
+            (void*) &strip[0][0], strip.size() * 2 * sizeof(float), ctx->m_BufferCbUserData);
+        stroke->m_IsUploaded = true;
     }
 
     void SharedRenderPaint::color(unsigned int value)
@@ -136,12 +729,20 @@ namespace rive
 
         getColorArrayFromUint(value, &m_Data.m_Colors[0]);
 
-        m_IsVisible = m_Data.m_Colors[3] > 0.0f;
+        m_Data.m_IsOpaque = m_Data.m_Colors[3] >= 1.0f;
+        m_IsVisible       = m_Data.m_Colors[3] > 0.0f;
+        m_DataHash        = hashPaintData(m_Data);
     }
 
     void SharedRenderPaint::linearGradient(float sx, float sy, float ex, float ey)
     {
-        m_Builder                 = new SharedRenderPaintBuilder();
+        if (m_Builder == 0)
+        {
+            m_Builder = new SharedRenderPaintBuilder();
+            m_Builder->m_Stops.SetCapacity(PaintData::MAX_STOPS);
+        }
+
+        m_Builder->m_Stops.SetSize(0);
         m_Builder->m_GradientType = FILL_TYPE_LINEAR;
         m_Builder->m_StartX       = sx;
         m_Builder->m_StartY       = sy;
@@ -151,7 +752,13 @@ namespace rive
 
     void SharedRenderPaint::radialGradient(float sx, float sy, float ex, float ey)
     {
-        m_Builder                 = new SharedRenderPaintBuilder();
+        if (m_Builder == 0)
+        {
+            m_Builder = new SharedRenderPaintBuilder();
+            m_Builder->m_Stops.SetCapacity(PaintData::MAX_STOPS);
+        }
+
+        m_Builder->m_Stops.SetSize(0);
         m_Builder->m_GradientType = FILL_TYPE_RADIAL;
         m_Builder->m_StartX       = sx;
         m_Builder->m_StartY       = sy;
@@ -161,12 +768,7 @@ namespace rive
 
     void SharedRenderPaint::addStop(unsigned int color, float stop)
     {
-        if (m_Builder->m_Stops.Size() == m_Builder->m_Stops.Capacity())
-        {
-            m_Builder->m_Stops.SetCapacity(m_Builder->m_Stops.Size() + 1);
-        }
-
-        m_Builder->m_Stops.Push({
+        pushGrow(m_Builder->m_Stops, {
             .m_Color = color,
             .m_Stop  = stop,
         });
@@ -183,7 +785,8 @@ namespace rive
         m_Data.m_GradientLimits[2] = m_Builder->m_EndX;
         m_Data.m_GradientLimits[3] = m_Builder->m_EndY;
 
-        m_IsVisible = false;
+        m_IsVisible       = false;
+        m_Data.m_IsOpaque = m_Data.m_StopCount > 0;
         assert(m_Data.m_StopCount < PaintData::MAX_STOPS);
         for (int i = 0; i < (int) m_Builder->m_Stops.Size(); ++i)
         {
@@ -195,12 +798,17 @@ namespace rive
             {
                 m_IsVisible = true;
             }
+
+            if (m_Data.m_Colors[i*4 + 3] < 1.0f)
+            {
+                m_Data.m_IsOpaque = false;
+            }
         }
 
+        m_DataHash = hashPaintData(m_Data);
+
+        // The builder is kept around, gradients are usually rebuilt every frame
         m_Builder->m_Stops.SetSize(0);
-        m_Builder->m_Stops.SetCapacity(0);
-        delete m_Builder;
-        m_Builder = 0;
     }
 
     bool SharedRenderPaint::isVisible()
@@ -213,137 +821,1207 @@ namespace rive
     ////////////////////////////////////////////////////////
     SharedRenderPath::SharedRenderPath(Context* ctx)
     : m_Context(ctx)
+    , m_IsPending(false)
+    , m_IsFlattenPending(false)
+    , m_ContourError(1.0f)
+    , m_RequestedError(FLT_MAX)
+    , m_LastRequestedError(FLT_MAX)
+    , m_SubPathError(FLT_MAX)
+    , m_RequestFrame(~0u)
+    , m_SubPathFrame(~0u)
+    , m_ContourVersion(0)
+    , m_IsContourDirty(true)
+    , m_LimitsVersion(~0u)
+    , m_StrokeUseCount(0)
     {}
 
-    void SharedRenderPath::renderStroke(SharedRenderer* renderer, SharedRenderPaint* renderPaint,
-        const Mat2D& transform, const Mat2D& localTransform)
+    SharedRenderPath::~SharedRenderPath()
+    {
+        for (uint32_t i = 0; i < m_Strokes.Size(); ++i)
+        {
+            delete m_Strokes[i].m_Stroke;
+            if (m_Strokes[i].m_Buffer)
+            {
+                m_Context->m_DestroyBufferCb(m_Strokes[i].m_Buffer, m_Context->m_BufferCbUserData);
+            }
+        }
+    }
+
+    // Returns the index of the stroke for these parameters, extruded from the current
+    // contour. When all entries are taken, the least recently used one that isn't used
+    // in this frame is replaced.
+    uint32_t SharedRenderPath::acquireStroke(float thickness, StrokeJoin join, StrokeCap cap)
+    {
+        const uint32_t version = contourVersion();
+        const uint32_t frame   = m_Context->m_Frame;
+        uint32_t idx           = 0;
+        uint32_t victim        = ~0u;
+        bool found             = false;
+
+        for (uint32_t i = 0; i < m_Strokes.Size(); ++i)
+        {
+            const StrokeCacheEntry& entry = m_Strokes[i];
+            if (entry.m_Thickness == thickness && entry.m_Join == join && entry.m_Cap == cap)
+            {
+                idx   = i;
+                found = true;
+                break;
+            }
+
+            if (entry.m_Frame != frame && (victim == ~0u || entry.m_LastUsed < m_Strokes[victim].m_LastUsed))
+            {
+                victim = i;
+            }
+        }
+
+        if (!found)
+        {
+            if (m_Strokes.Size() < MAX_STROKE_CACHE_ENTRIES || victim == ~0u)
+            {
+                if (m_Strokes.Capacity() == 0)
+                {
+                    m_Strokes.SetCapacity(MAX_STROKE_CACHE_ENTRIES);
+                }
+
+                idx = m_Strokes.Size();
+                pushGrow(m_Strokes, {
+                    .m_Stroke = new ContourStroke(),
+                    .m_Buffer = 0,
+                });
+            }
+            else
+            {
+                idx = victim;
+            }
+
+            StrokeCacheEntry& entry = m_Strokes[idx];
+            entry.m_Thickness       = thickness;
+            entry.m_Join            = join;
+            entry.m_Cap             = cap;
+            entry.m_IsExtruded      = false;
+        }
+
+        StrokeCacheEntry& entry = m_Strokes[idx];
+        entry.m_LastUsed        = ++m_StrokeUseCount;
+        entry.m_Frame           = frame;
+
+        if (!entry.m_IsExtruded || entry.m_ContourVersion != version)
+        {
+            static Mat2D identity;
+            entry.m_Stroke->reset();
+            extrudeStroke(entry.m_Stroke, join, cap, thickness / 2.0f, identity);
+            entry.m_ContourVersion = version;
+            entry.m_IsExtruded     = true;
+            entry.m_IsUploaded     = false;
+        }
+
+        return idx;
+    }
+
+    void SharedRenderPath::reset()
+    {
+        ContourRenderPath::reset();
+        m_Verbs.SetSize(0);
+        m_Points.SetSize(0);
+        m_ContourVersion++;
+        m_IsContourDirty = true;
+    }
+
+    void SharedRenderPath::addRenderPath(RenderPath* path, const Mat2D& transform)
+    {
+        ContourRenderPath::addRenderPath(path, transform);
+        m_ContourVersion++;
+        m_IsContourDirty = true;
+    }
+
+    void SharedRenderPath::moveTo(float x, float y)
+    {
+        ContourRenderPath::moveTo(x, y);
+        ensureCapacity(m_Points, m_Points.Size() + 2);
+        pushGrow(m_Verbs, (uint8_t) PATH_VERB_MOVE);
+        m_Points.Push(x);
+        m_Points.Push(y);
+        m_ContourVersion++;
+        m_IsContourDirty = true;
+    }
+
+    void SharedRenderPath::lineTo(float x, float y)
+    {
+        ContourRenderPath::lineTo(x, y);
+        ensureCapacity(m_Points, m_Points.Size() + 2);
+        pushGrow(m_Verbs, (uint8_t) PATH_VERB_LINE);
+        m_Points.Push(x);
+        m_Points.Push(y);
+        m_ContourVersion++;
+        m_IsContourDirty = true;
+    }
+
+    void SharedRenderPath::cubicTo(float ox, float oy, float ix, float iy, float x, float y)
+    {
+        ContourRenderPath::cubicTo(ox, oy, ix, iy, x, y);
+        ensureCapacity(m_Points, m_Points.Size() + 6);
+        pushGrow(m_Verbs, (uint8_t) PATH_VERB_CUBIC);
+        m_Points.Push(ox);
+        m_Points.Push(oy);
+        m_Points.Push(ix);
+        m_Points.Push(iy);
+        m_Points.Push(x);
+        m_Points.Push(y);
+        m_ContourVersion++;
+        m_IsContourDirty = true;
+    }
+
+    void SharedRenderPath::close()
+    {
+        ContourRenderPath::close();
+        pushGrow(m_Verbs, (uint8_t) PATH_VERB_CLOSE);
+        m_ContourVersion++;
+        m_IsContourDirty = true;
+    }
+
+    void SharedRenderPath::setContourError(float contourError)
+    {
+        if (m_ContourError != contourError)
+        {
+            m_ContourError   = contourError;
+            m_IsContourDirty = true;
+        }
+    }
+
+    // A path can be drawn at several scales in a frame, it is flattened with the finest
+    // error any draw asked for in the frame or in the last frame it was drawn. The
+    // contour then only gets coarser once a whole frame went without the finer draw,
+    // instead of alternating between the draws.
+    void SharedRenderPath::requestContourError(float contourError)
+    {
+        const uint32_t frame = m_Context->m_Frame;
+        if (m_RequestFrame != frame)
+        {
+            m_LastRequestedError = m_RequestedError;
+            m_RequestedError     = contourError;
+            m_RequestFrame       = frame;
+        }
+        else
+        {
+            m_RequestedError = fminf(m_RequestedError, contourError);
+        }
+        setContourError(fminf(fminf(m_RequestedError, m_LastRequestedError), m_SubPathError));
+    }
+
+    // Containers pass their error down when they are flattened, which is not every frame.
+    // The finest one of a frame is kept until a container is flattened again, so a
+    // subpath of several containers doesn't follow whichever was flattened last.
+    void SharedRenderPath::requestSubPathContourError(float contourError)
+    {
+        const uint32_t frame = m_Context->m_Frame;
+        if (m_SubPathFrame != frame)
+        {
+            m_SubPathError = contourError;
+            m_SubPathFrame = frame;
+        }
+        else
+        {
+            m_SubPathError = fminf(m_SubPathError, contourError);
+        }
+        setContourError(fminf(fminf(m_RequestedError, m_LastRequestedError), m_SubPathError));
+    }
+
+    // A container is dirty if any subpath is, even if the container itself wasn't rebuilt
+    bool SharedRenderPath::isContourDirty() const
+    {
+        if (m_IsContourDirty)
+        {
+            return true;
+        }
+
+        for (int i = 0; i < (int) m_SubPaths.size(); ++i)
+        {
+            if (((const SharedRenderPath*) m_SubPaths[i].path())->isContourDirty())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // The versions only ever grow, so the sum changes whenever any subpath changes
+    uint32_t SharedRenderPath::contourVersion() const
+    {
+        uint32_t version = m_ContourVersion;
+        for (int i = 0; i < (int) m_SubPaths.size(); ++i)
+        {
+            version += ((const SharedRenderPath*) m_SubPaths[i].path())->contourVersion();
+        }
+        return version;
+    }
+
+    // Subpaths are flattened with at most the container's contour error. Each subpath keeps
+    // its contour, so only the subpaths that changed since the last update are flattened.
+    void SharedRenderPath::updateContour()
+    {
+        if (isContainer())
+        {
+            for (int i = 0; i < (int) m_SubPaths.size(); ++i)
+            {
+                SharedRenderPath* sharedPath = (SharedRenderPath*) m_SubPaths[i].path();
+                sharedPath->requestSubPathContourError(m_ContourError);
+                sharedPath->updateContour();
+            }
+        }
+        else if (m_IsContourDirty)
+        {
+            flattenContour(m_Verbs.Begin(), m_Verbs.Size(), m_Points.Begin(), m_ContourError, m_Contour);
+        }
+
+        m_IsContourDirty = false;
+    }
+
+    // Collects the dirty leaves below this path that aren't collected yet, after passing
+    // the contour error down. A leaf can be a subpath of several containers and be drawn
+    // on its own as well, so it must only be flattened by one of them.
+    void SharedRenderPath::gatherDirtyContours(jc::Array<SharedRenderPath*>& paths)
+    {
+        if (isContainer())
+        {
+            for (int i = 0; i < (int) m_SubPaths.size(); ++i)
+            {
+                SharedRenderPath* sharedPath = (SharedRenderPath*) m_SubPaths[i].path();
+                sharedPath->requestSubPathContourError(m_ContourError);
+                sharedPath->gatherDirtyContours(paths);
+            }
+            m_IsContourDirty = false;
+        }
+        else if (m_IsContourDirty && !m_IsFlattenPending)
+        {
+            m_IsFlattenPending = true;
+            pushGrow(paths, this);
+        }
+    }
+
+    // Grows bounds by the transformed control point bounds. The curves stay within the
+    // hull of their control points, so this holds for any contour error and never needs
+    // the contour to be flattened first.
+    void SharedRenderPath::addBounds(const Mat2D& transform, float* bounds)
+    {
+        if (isContainer())
+        {
+            for (int i = 0; i < (int) m_SubPaths.size(); ++i)
+            {
+                Mat2D subPathTransform;
+                Mat2D::multiply(subPathTransform, transform, m_SubPaths[i].transform());
+                ((SharedRenderPath*) m_SubPaths[i].path())->addBounds(subPathTransform, bounds);
+            }
+            return;
+        }
+
+        const uint32_t pointCount = m_Points.Size() / 2;
+        if (pointCount == 0)
+        {
+            return;
+        }
+
+        // Culling asks for the bounds of every draw, they only change with the path
+        if (m_LimitsVersion != m_ContourVersion)
+        {
+            m_Limits = { FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
+            for (uint32_t i = 0; i < pointCount; ++i)
+            {
+                m_Limits.m_MinX = fminf(m_Limits.m_MinX, m_Points[i*2]);
+                m_Limits.m_MinY = fminf(m_Limits.m_MinY, m_Points[i*2 + 1]);
+                m_Limits.m_MaxX = fmaxf(m_Limits.m_MaxX, m_Points[i*2]);
+                m_Limits.m_MaxY = fmaxf(m_Limits.m_MaxY, m_Points[i*2 + 1]);
+            }
+            m_LimitsVersion = m_ContourVersion;
+        }
+
+        const float minX = m_Limits.m_MinX;
+        const float minY = m_Limits.m_MinY;
+        const float maxX = m_Limits.m_MaxX;
+        const float maxY = m_Limits.m_MaxY;
+        const float corners[] = { minX, minY, maxX, minY, maxX, maxY, minX, maxY };
+        float transformed[8];
+        transformVertices(transform, corners, transformed, 4, bounds);
+    }
+
+    // Gets the world space rect the path covers if it is a single contour of four straight
+    // edges that stay axis aligned under the transform. The edges are compared exactly,
+    // so the rect is what the path would have filled.
+    bool SharedRenderPath::getAxisAlignedRect(const Mat2D& transform, float* rect)
+    {
+        if (isContainer())
+        {
+            if (m_SubPaths.size() != 1)
+            {
+                return false;
+            }
+
+            Mat2D subPathTransform;
+            Mat2D::multiply(subPathTransform, transform, m_SubPaths[0].transform());
+            return ((SharedRenderPath*) m_SubPaths[0].path())->getAxisAlignedRect(subPathTransform, rect);
+        }
+
+        // Only scales, flips and quarter turns keep the edges axis aligned
+        if (!(transform[1] == 0.0f && transform[2] == 0.0f) && !(transform[0] == 0.0f && transform[3] == 0.0f))
+        {
+            return false;
+        }
+
+        // A move and three or four lines, the fourth line may only return to the start
+        uint32_t verbCount = m_Verbs.Size();
+        if (verbCount > 0 && m_Verbs[verbCount - 1] == PATH_VERB_CLOSE)
+        {
+            verbCount--;
+        }
+
+        if (verbCount < 4 || verbCount > 5 || m_Verbs[0] != PATH_VERB_MOVE)
+        {
+            return false;
+        }
+
+        for (uint32_t i = 1; i < verbCount; ++i)
+        {
+            if (m_Verbs[i] != PATH_VERB_LINE)
+            {
+                return false;
+            }
+        }
+
+        const float* p = m_Points.Begin();
+        if (verbCount == 5 && (p[8] != p[0] || p[9] != p[1]))
+        {
+            return false;
+        }
+
+        // The edges alternate between horizontal and vertical, starting with either
+        const bool isHorizontalFirst = p[1] == p[3] && p[2] == p[4] && p[5] == p[7] && p[6] == p[0];
+        const bool isVerticalFirst   = p[0] == p[2] && p[3] == p[5] && p[4] == p[6] && p[7] == p[1];
+        if (!isHorizontalFirst && !isVerticalFirst)
+        {
+            return false;
+        }
+
+        const float corners[] = { p[0], p[1], p[4], p[5] };
+        float transformed[4];
+        rect[0] = FLT_MAX;
+        rect[1] = FLT_MAX;
+        rect[2] = -FLT_MAX;
+        rect[3] = -FLT_MAX;
+        transformVertices(transform, corners, transformed, 2, rect);
+        return true;
+    }
+
+    // The events refer to the stroke by the path it was extruded from and its index
+    void SharedRenderPath::renderStroke(SharedRenderer* renderer, SharedRenderPaint* renderPaint, SharedRenderPath* strokePath,
+        uint32_t strokeIdx, const Mat2D& transform, const Mat2D& localTransform)
+    {
+        if (isContainer())
+        {
+            for (size_t i = 0; i < m_SubPaths.size(); ++i)
+            {
+                ((SharedRenderPath*)m_SubPaths[i].path())->renderStroke(renderer, renderPaint, strokePath, strokeIdx, transform, localTransform);
+            }
+            return;
+        }
+
+        ContourStroke* stroke = strokePath->m_Strokes[strokeIdx].m_Stroke;
+
+        size_t start, end;
+        stroke->nextRenderOffset(start, end);
+
+        renderer->setPaint(renderPaint);
+
+        PathDrawEvent evt = {
+            .m_Type           = EVENT_DRAW_STROKE,
+            .m_Path              = (HRenderPath) strokePath,
+            .m_OffsetStart       = (uint32_t) start,
+            .m_OffsetEnd         = (uint32_t) end,
+            .m_TransformWorldIdx = renderer->internTransform(transform),
+            .m_TransformLocalIdx = renderer->internTransform(localTransform),
+            .m_Idx               = strokeIdx,
+        };
+
+        renderer->pushDrawEvent(evt);
+    }
+
+    ////////////////////////////////////////////////////////
+    // Shared Renderer
+    ////////////////////////////////////////////////////////
+
+    static const float g_NoClipRect[4] = { -FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX };
+
+    SharedRenderer::SharedRenderer()
+    : m_Parent(0)
+    , m_BatchVertexBuffer(0)
+    , m_BatchIndexBuffer(0)
+    , m_BatchMeshStart(0)
+    , m_InstanceStart(0)
+    , m_InstanceCount(0)
+    , m_DrawCommandCount(0)
+    , m_RecordingFormat(RECORDING_FORMAT_EVENTS)
+    , m_IndexBuffer(0)
+    , m_ContourScale(1.0f)
+    {
+        m_IsBatchingSupported = false;
+        m_IsClipRetained      = false;
+        m_IsInstanced         = false;
+        m_IsCulling           = false;
+        memcpy(m_ClipRect, g_NoClipRect, sizeof(m_ClipRect));
+        memcpy(m_AppliedClipRect, g_NoClipRect, sizeof(m_AppliedClipRect));
+        memset(m_TransformCache, 0, sizeof(m_TransformCache));
+        memset(m_PaintCache, 0, sizeof(m_PaintCache));
+        resetTransformPalette();
+        resetPaintTable();
+
+        m_Indices.emplace_back(0);
+        m_Indices.emplace_back(1);
+        m_Indices.emplace_back(2);
+        m_Indices.emplace_back(2);
+        m_Indices.emplace_back(3);
+        m_Indices.emplace_back(0);
+    }
+
+    SharedRenderer::~SharedRenderer()
+    {
+        m_Context->m_DestroyBufferCb(m_IndexBuffer, m_Context->m_BufferCbUserData);
+        m_Context->m_DestroyBufferCb(m_BatchVertexBuffer, m_Context->m_BufferCbUserData);
+        m_Context->m_DestroyBufferCb(m_BatchIndexBuffer, m_Context->m_BufferCbUserData);
+    }
+
+    void SharedRenderer::updateIndexBuffer(size_t contourLength)
+    {
+        if (contourLength < 2)
+        {
+            return;
+        }
+        uint32_t edgeCount       = (m_Indices.size() - 6) / 3;
+        uint32_t targetEdgeCount = contourLength - 2;
+        if (edgeCount < targetEdgeCount)
+        {
+            while (edgeCount < targetEdgeCount)
+            {
+                m_Indices.push_back(3);
+                m_Indices.push_back(edgeCount + 4);
+                m_Indices.push_back(edgeCount + 5);
+                edgeCount++;
+            }
+
+            m_IndexBuffer = m_Context->m_RequestBufferCb(m_IndexBuffer,
+                BUFFER_TYPE_INDEX_BUFFER, &m_Indices[0], m_Indices.size() * sizeof(int),
+                m_Context->m_BufferCbUserData);
+        }
+    }
+
+    // Rect clips can't follow the instance transforms with a single scissor, so they
+    // only bypass the stencil while no instances are set.
+    void SharedRenderer::clipPath(RenderPath* path)
+    {
+        float rect[4];
+        if (!m_IsInstanced && ((SharedRenderPath*) path)->getAxisAlignedRect(m_Transform, rect))
+        {
+            m_ClipRect[0]     = fmaxf(m_ClipRect[0], rect[0]);
+            m_ClipRect[1]     = fmaxf(m_ClipRect[1], rect[1]);
+            m_ClipRect[2]     = fminf(m_ClipRect[2], rect[2]);
+            m_ClipRect[3]     = fminf(m_ClipRect[3], rect[3]);
+            m_IsClippingDirty = true;
+            return;
+        }
+
+        const uint32_t below   = m_ClipPaths.Size() > 0 ? m_ClipPaths[m_ClipPaths.Size() - 1].m_Hash : 2166136261u;
+        const uint32_t version = ((SharedRenderPath*) path)->contourVersion();
+        pushGrow(m_ClipPaths, {
+            .m_Path      = path,
+            .m_Transform = m_Transform,
+            .m_Version   = version,
+            .m_Hash      = hashClipPath(below, path, version, m_Transform),
+        });
+        m_IsClippingDirty = true;
+    }
+
+    void SharedRenderer::transform(const Mat2D& transform)
+    {
+        Mat2D::multiply(m_Transform, m_Transform, transform);
+    }
+
+    void SharedRenderer::save()
+    {
+        StackEntry entry = {};
+        entry.m_Transform = Mat2D(m_Transform);
+
+        assert(m_ClipPaths.Size() < STACK_ENTRY_MAX_CLIP_PATHS);
+
+        entry.m_ClipPathsCount = m_ClipPaths.Size();
+        memcpy(entry.m_ClipPaths, m_ClipPaths.Begin(), m_ClipPaths.Size() * sizeof(PathDescriptor));
+        memcpy(entry.m_ClipRect, m_ClipRect, sizeof(m_ClipRect));
+
+        pushGrow(m_ClipPathStack, entry);
+    }
+
+    void SharedRenderer::restore()
+    {
+        const StackEntry last = m_ClipPathStack.Pop();
+        m_Transform = last.m_Transform;
+
+        if (memcmp(m_ClipRect, last.m_ClipRect, sizeof(m_ClipRect)) != 0)
+        {
+            memcpy(m_ClipRect, last.m_ClipRect, sizeof(m_ClipRect));
+            m_IsClippingDirty = true;
+        }
+
+        // Most saves don't clip, restoring them leaves the clip stack as it is
+        if (isClipStackEqual(last.m_ClipPaths, last.m_ClipPathsCount))
+        {
+            return;
+        }
+
+        m_ClipPaths.SetSize(0);
+        ensureCapacity(m_ClipPaths, last.m_ClipPathsCount);
+        m_IsClippingDirty = true;
+
+        for (int i = 0; i < last.m_ClipPathsCount; ++i)
+        {
+            m_ClipPaths.Push(last.m_ClipPaths[i]);
+        }
+    }
+
+    void SharedRenderer::resetTransformPalette()
+    {
+        m_TransformPalette.SetSize(0);
+        pushGrow(m_TransformPalette, Mat2D());
+        m_LastTransformIdx = 0;
+    }
+
+    uint32_t SharedRenderer::internTransform(const Mat2D& transform)
+    {
+        // Consecutive events mostly share their transform, e.g all paths of a shape
+        if (m_TransformPalette[m_LastTransformIdx] == transform)
+        {
+            return m_LastTransformIdx;
+        }
+
+        // The cache can hold indices from earlier frames, those just fail the compare
+        uint32_t slot   = hashTransform(transform) & (TRANSFORM_CACHE_SIZE - 1);
+        uint32_t cached = m_TransformCache[slot];
+        if (cached < m_TransformPalette.Size() && m_TransformPalette[cached] == transform)
+        {
+            m_LastTransformIdx = cached;
+            return cached;
+        }
+
+        uint32_t idx = m_TransformPalette.Size();
+        pushGrow(m_TransformPalette, transform);
+        m_TransformCache[slot] = idx;
+        m_LastTransformIdx     = idx;
+        return idx;
+    }
+
+    static void updateContourJob(void* jobData, uint32_t jobIndex)
+    {
+        SharedRenderPath** paths = (SharedRenderPath**) jobData;
+        paths[jobIndex]->updateContour();
+    }
+
+    static void prepareBuffersJob(void* jobData, uint32_t jobIndex)
+    {
+        SharedRenderPath** paths = (SharedRenderPath**) jobData;
+        paths[jobIndex]->prepareBuffers();
+    }
+
+    static void buildBuffersJob(void* jobData, uint32_t jobIndex)
+    {
+        SharedRenderPath** paths = (SharedRenderPath**) jobData;
+        paths[jobIndex]->buildBuffers();
+    }
+
+    // Command lists can be recorded on any thread, so they leave all buffer requests
+    // to the renderer they are appended to.
+    bool SharedRenderer::defersPathUpdates() const
+    {
+        return m_Parent != 0 || m_Context->m_JobSystem.m_SubmitCb != 0;
+    }
+
+    void SharedRenderer::queueStroke(SharedRenderPath* path, uint32_t strokeIdx)
+    {
+        pushGrow(m_PendingStrokes, { .m_Path = path, .m_Idx = strokeIdx });
+    }
+
+    void SharedRenderer::queuePath(SharedRenderPath* path)
+    {
+        if (!path->m_IsPending)
+        {
+            path->m_IsPending = true;
+            pushGrow(m_PendingPaths, path);
+        }
+    }
+
+    static void runPathJobs(const JobSystem& jobs, JobFunction fn, jc::Array<SharedRenderPath*>& paths)
+    {
+        if (paths.Size() == 0)
+        {
+            return;
+        }
+
+        if (jobs.m_SubmitCb)
+        {
+            jobs.m_SubmitCb(fn, paths.Begin(), paths.Size(), jobs.m_UserData);
+            jobs.m_WaitCb(jobs.m_UserData);
+        }
+        else
+        {
+            for (uint32_t i = 0; i < paths.Size(); ++i)
+            {
+                fn(paths.Begin(), i);
+            }
+        }
+    }
+
+    void SharedRenderer::processPendingPaths()
+    {
+        const uint32_t count = m_PendingPaths.Size();
+        if (count == 0)
+        {
+            return;
+        }
+
+        // Contours are flattened first, one job per dirty leaf, so that the paths
+        // only read their subpaths while their buffers are prepared.
+        m_FlattenPaths.SetSize(0);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            m_PendingPaths[i]->gatherDirtyContours(m_FlattenPaths);
+        }
+
+        runPathJobs(m_Context->m_JobSystem, updateContourJob, m_FlattenPaths);
+
+        for (uint32_t i = 0; i < m_FlattenPaths.Size(); ++i)
+        {
+            m_FlattenPaths[i]->m_IsFlattenPending = false;
+        }
+
+        runPathJobs(m_Context->m_JobSystem, prepareBuffersJob, m_PendingPaths);
+
+        // Paths are resolved in order, so of all paths that share new geometry
+        // only the first one builds it.
+        m_BuildPaths.SetSize(0);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (m_PendingPaths[i]->resolveBuffers())
+            {
+                pushGrow(m_BuildPaths, m_PendingPaths[i]);
+            }
+        }
+
+        runPathJobs(m_Context->m_JobSystem, buildBuffersJob, m_BuildPaths);
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            m_PendingPaths[i]->uploadBuffers(this);
+            m_PendingPaths[i]->m_IsPending = false;
+        }
+        m_PendingPaths.SetSize(0);
+    }
+
+    void SharedRenderer::batchMesh(const TessellationRenderPath* path, const Mat2D& transform, const PaintData& paint)
+    {
+        BatchMesh mesh = {
+            .m_Path      = path,
+            .m_Transform = transform,
+            .m_Color     = packColor(&paint.m_Colors[0]),
+        };
+        pushGrow(m_BatchMeshes, mesh);
+    }
+
+    // Batches are built by every renderer, command lists included
+    static thread_local jc::Array<float> g_TransformScratch;
+
+    void SharedRenderer::buildBatches()
+    {
+        m_BatchVertices.SetSize(0);
+        m_BatchIndices.SetSize(0);
+        m_BatchMeshOffsets.SetSize(0);
+        ensureCapacity(m_BatchMeshOffsets, m_BatchMeshes.Size() + 1);
+
+        for (uint32_t meshIndex = 0; meshIndex < m_BatchMeshes.Size(); ++meshIndex)
+        {
+            const BatchMesh& mesh      = m_BatchMeshes[meshIndex];
+            const GeometryCacheEntry* geometry = mesh.m_Path->m_Geometry;
+
+            m_BatchMeshOffsets.Push(m_BatchIndices.Size());
+            if (geometry == 0)
+            {
+                continue;
+            }
+
+            const int* indices         = geometry->m_Indices.Begin();
+            const uint32_t vertexCount = geometry->m_Vertices.Size() / 2;
+            const uint32_t indexCount  = geometry->m_Indices.Size();
+            const uint32_t baseVertex  = m_BatchVertices.Size();
+
+            ensureCapacity(m_BatchVertices, baseVertex + vertexCount);
+            ensureCapacity(m_BatchIndices, m_BatchIndices.Size() + indexCount);
+
+            // Transform into the scratch buffer first, the batch vertices are
+            // interleaved with the color
+            jc::Array<float>& scratch = g_TransformScratch;
+            ensureCapacity(scratch, vertexCount * 2);
+            transformVertices(mesh.m_Transform, geometry->m_Vertices.Begin(), scratch.Begin(), vertexCount, 0);
+
+            const float* vertices = scratch.Begin();
+            BatchVertex* vxOut    = m_BatchVertices.End();
+            for (uint32_t i = 0; i < vertexCount; ++i)
+            {
+                vxOut[i].m_X     = vertices[i*2];
+                vxOut[i].m_Y     = vertices[i*2 + 1];
+                vxOut[i].m_Color = mesh.m_Color;
+            }
+            m_BatchVertices.SetSize(baseVertex + vertexCount);
+
+            uint32_t* ixOut = m_BatchIndices.End();
+            for (uint32_t i = 0; i < indexCount; ++i)
+            {
+                ixOut[i] = baseVertex + (uint32_t) indices[i];
+            }
+            m_BatchIndices.SetSize(m_BatchIndices.Size() + indexCount);
+        }
+
+        m_BatchMeshOffsets.Push(m_BatchIndices.Size());
+    }
+
+    void SharedRenderer::flushBatch()
+    {
+        if (m_BatchMeshStart == m_BatchMeshes.Size())
+        {
+            return;
+        }
+
+        PathDrawEvent evt = {
+            .m_Type        = EVENT_DRAW_BATCH,
+            .m_OffsetStart = m_BatchMeshStart,
+            .m_OffsetEnd   = m_BatchMeshes.Size(),
+        };
+
+        pushDrawEvent(evt);
+        m_BatchMeshStart = m_BatchMeshes.Size();
+    }
+
+    void SharedRenderer::endFrame()
+    {
+        flushBatch();
+
+        // Batches read the tessellated meshes, so the pending paths go first
+        processPendingPaths();
+        buildBatches();
+
+        if (m_BatchIndices.Size() > 0)
+        {
+            m_BatchVertexBuffer = m_Context->m_RequestBufferCb(m_BatchVertexBuffer, BUFFER_TYPE_VERTEX_BUFFER,
+                m_BatchVertices.Begin(), m_BatchVertices.Size() * sizeof(BatchVertex), m_Context->m_BufferCbUserData);
+            m_BatchIndexBuffer  = m_Context->m_RequestBufferCb(m_BatchIndexBuffer, BUFFER_TYPE_INDEX_BUFFER,
+                m_BatchIndices.Begin(), m_BatchIndices.Size() * sizeof(uint32_t), m_Context->m_BufferCbUserData);
+        }
+    }
+
+    void SharedRenderer::appendCommandList(SharedRenderer* list)
+    {
+        list->flushBatch();
+        flushBatch();
+
+        // Lists are recorded without any clips applied or instances set
+        if (m_AppliedClips.Size() > 0)
+        {
+            disableClipping();
+        }
+        setAppliedClipRect(g_NoClipRect);
+        if (m_IsInstanced)
+        {
+            setInstances(&Mat2D::identity(), 1);
+        }
+
+        const uint32_t meshBase     = m_BatchMeshes.Size();
+        const uint32_t instanceBase = m_InstanceTransforms.Size();
+
+        ensureCapacity(m_BatchMeshes, meshBase + list->m_BatchMeshes.Size());
+        for (uint32_t i = 0; i < list->m_BatchMeshes.Size(); ++i)
+        {
+            m_BatchMeshes.Push(list->m_BatchMeshes[i]);
+        }
+        m_BatchMeshStart = m_BatchMeshes.Size();
+
+        ensureCapacity(m_InstanceTransforms, instanceBase + list->m_InstanceTransforms.Size());
+        for (uint32_t i = 0; i < list->m_InstanceTransforms.Size(); ++i)
+        {
+            m_InstanceTransforms.Push(list->m_InstanceTransforms[i]);
+        }
+
+        // Everything that indexes into the list is rebased, transforms by interning
+        // them from the list's palette into ours.
+        for (uint32_t i = 0; i < list->m_DrawEvents.Size(); ++i)
+        {
+            PathDrawEvent evt = list->m_DrawEvents[i];
+            if (eventHasTransforms(evt.m_Type))
+            {
+                evt.m_TransformWorldIdx = internTransform(list->m_TransformPalette[evt.m_TransformWorldIdx]);
+                evt.m_TransformLocalIdx = internTransform(list->m_TransformPalette[evt.m_TransformLocalIdx]);
+            }
+            switch(evt.m_Type)
+            {
+                case EVENT_DRAW_BATCH:
+                    evt.m_OffsetStart += meshBase;
+                    evt.m_OffsetEnd   += meshBase;
+                    break;
+                case EVENT_SET_INSTANCES:
+                    evt.m_OffsetStart += instanceBase;
+                    evt.m_OffsetEnd   += instanceBase;
+                    break;
+                case EVENT_SET_PAINT:
+                {
+                    const PaintData& data = list->m_PaintTable[evt.m_PaintId];
+                    evt.m_PaintId         = internPaint(data, hashPaintData(data));
+                } break;
+                default:break;
+            }
+            pushDrawEvent(evt);
+        }
+
+        // Paths stay flagged as pending, they are uploaded with the rest of ours
+        ensureCapacity(m_PendingPaths, m_PendingPaths.Size() + list->m_PendingPaths.Size());
+        for (uint32_t i = 0; i < list->m_PendingPaths.Size(); ++i)
+        {
+            m_PendingPaths.Push(list->m_PendingPaths[i]);
+        }
+        list->m_PendingPaths.SetSize(0);
+
+        for (uint32_t i = 0; i < list->m_PendingStrokes.Size(); ++i)
+        {
+            const PendingStroke& pending = list->m_PendingStrokes[i];
+            uploadStroke(m_Context, &pending.m_Path->m_Strokes[pending.m_Idx]);
+        }
+        list->m_PendingStrokes.SetSize(0);
+
+        // Continue from the state the list ended in
+        ensureCapacity(m_AppliedClips, list->m_AppliedClips.Size());
+        m_AppliedClips.SetSize(0);
+        for (uint32_t i = 0; i < list->m_AppliedClips.Size(); ++i)
+        {
+            m_AppliedClips.Push(list->m_AppliedClips[i]);
+        }
+        memcpy(m_AppliedClipRect, list->m_AppliedClipRect, sizeof(m_AppliedClipRect));
+        m_IsClipping      = list->m_IsClipping;
+        m_IsInstanced     = list->m_IsInstanced;
+        m_InstanceStart   = instanceBase + list->m_InstanceStart;
+        m_InstanceCount   = list->m_InstanceCount;
+        m_IsClippingDirty = true;
+        m_RenderPaint     = list->m_RenderPaint;
+    }
+
+    // The hash only rejects quickly, a collision must not skip a clip
+    static inline bool isSameClipPath(const PathDescriptor& a, const PathDescriptor& b)
+    {
+        return a.m_Hash == b.m_Hash && a.m_Path == b.m_Path && a.m_Version == b.m_Version && a.m_Transform == b.m_Transform;
+    }
+
+    // Clips are only pushed between a save and its restore, so the levels below the
+    // top are the saved ones whenever the sizes match.
+    bool SharedRenderer::isClipStackEqual(const PathDescriptor* clipPaths, uint32_t count) const
+    {
+        return m_ClipPaths.Size() == count && (count == 0 || isSameClipPath(m_ClipPaths[count - 1], clipPaths[count - 1]));
+    }
+
+    // Number of clip paths at the bottom of the stack that are already in the stencil
+    uint32_t SharedRenderer::getAppliedClipPrefix() const
+    {
+        uint32_t limit = m_ClipPaths.Size() < m_AppliedClips.Size() ? m_ClipPaths.Size() : m_AppliedClips.Size();
+        uint32_t count = 0;
+        while (count < limit && isSameClipPath(m_ClipPaths[count], m_AppliedClips[count]))
+        {
+            count++;
+        }
+        return count;
+    }
+
+    // The stencil is at clip level 'level' when the section starts, zero means it has to
+    // be cleared. Its clip draws first pop the stencil down to 'popLevel', one level per
+    // draw, and then push the remaining clip paths from 'first' on. The clip bounds are
+    // sent as the transform of the quad [-1, 1] onto the union of the bounds of the pushed
+    // clip paths in world space, or as a zero transform if there are none.
+    void SharedRenderer::pushClippingBegin(uint32_t level, uint32_t popLevel, uint32_t first)
+    {
+        float bounds[4] = { FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for (int i = (int) first; i < (int) m_ClipPaths.Size(); ++i)
+        {
+            const PathDescriptor& pd = m_ClipPaths[i];
+            ((SharedRenderPath*) pd.m_Path)->addBounds(pd.m_Transform, bounds);
+        }
+
+        Mat2D boundsTransform;
+        if (bounds[0] <= bounds[2] && bounds[1] <= bounds[3])
+        {
+            boundsTransform[0] = (bounds[2] - bounds[0]) * 0.5f;
+            boundsTransform[3] = (bounds[3] - bounds[1]) * 0.5f;
+            boundsTransform[4] = (bounds[2] + bounds[0]) * 0.5f;
+            boundsTransform[5] = (bounds[3] + bounds[1]) * 0.5f;
+        }
+        else
+        {
+            boundsTransform[0] = 0.0f;
+            boundsTransform[3] = 0.0f;
+        }
+
+        PathDrawEvent evt = {
+            .m_Type              = EVENT_CLIPPING_BEGIN,
+            .m_TransformWorldIdx = internTransform(boundsTransform),
+            .m_Idx               = popLevel,
+            .m_AppliedClipCount  = level,
+        };
+        pushDrawEvent(evt);
+    }
+
+    void SharedRenderer::setAppliedClips()
     {
-        if (isContainer())
+        ensureCapacity(m_AppliedClips, m_ClipPaths.Size());
+        m_AppliedClips.SetSize(0);
+
+        for (int i = 0; i < (int) m_ClipPaths.Size(); ++i)
         {
-            for (size_t i = 0; i < m_SubPaths.size(); ++i)
-            {
-                ((SharedRenderPath*)m_SubPaths[i].path())->renderStroke(renderer, renderPaint, transform, localTransform);
-            }
-            return;
+            m_AppliedClips.Push(m_ClipPaths[i]);
         }
+    }
 
-        ContourStroke* stroke = renderPaint->m_Stroke;
+    // The scissor rect is sent like the clip bounds, as the transform of the quad [-1, 1]
+    // onto it in world space. m_IsClipping is cleared when the scissor is removed.
+    void SharedRenderer::setAppliedClipRect(const float* rect)
+    {
+        if (memcmp(m_AppliedClipRect, rect, sizeof(m_AppliedClipRect)) == 0)
+        {
+            return;
+        }
 
-        size_t start, end;
-        stroke->nextRenderOffset(start, end);
+        memcpy(m_AppliedClipRect, rect, sizeof(m_AppliedClipRect));
 
-        renderer->setPaint(renderPaint);
+        const bool hasClipRect = memcmp(rect, g_NoClipRect, sizeof(g_NoClipRect)) != 0;
+        Mat2D rectTransform;
+        rectTransform[0] = hasClipRect ? fmaxf(rect[2] - rect[0], 0.0f) * 0.5f : 0.0f;
+        rectTransform[3] = hasClipRect ? fmaxf(rect[3] - rect[1], 0.0f) * 0.5f : 0.0f;
+        rectTransform[4] = hasClipRect ? (rect[2] + rect[0]) * 0.5f : 0.0f;
+        rectTransform[5] = hasClipRect ? (rect[3] + rect[1]) * 0.5f : 0.0f;
 
         PathDrawEvent evt = {
-            .m_Type           = EVENT_DRAW_STROKE,
-            .m_TransformWorld = transform,
-            .m_TransformLocal = localTransform,
-            .m_OffsetStart    = (uint32_t) start,
-            .m_OffsetEnd      = (uint32_t) end,
+            .m_Type              = EVENT_CLIPPING_SCISSOR,
+            .m_TransformWorldIdx = internTransform(rectTransform),
+            .m_IsClipping        = hasClipRect,
         };
-
-        renderer->pushDrawEvent(evt);
+        pushDrawEvent(evt);
     }
 
-    ////////////////////////////////////////////////////////
-    // Shared Renderer
-    ////////////////////////////////////////////////////////
-
-    SharedRenderer::SharedRenderer()
-    : m_IndexBuffer(0)
+    void SharedRenderer::disableClipping()
     {
-        m_Indices.emplace_back(0);
-        m_Indices.emplace_back(1);
-        m_Indices.emplace_back(2);
-        m_Indices.emplace_back(2);
-        m_Indices.emplace_back(3);
-        m_Indices.emplace_back(0);
+        m_AppliedClips.SetSize(0);
+        m_IsClipping      = false;
+        m_IsClippingDirty = true;
     }
 
-    SharedRenderer::~SharedRenderer()
+    void SharedRenderer::setInstances(const Mat2D* transforms, uint32_t count)
     {
-        m_Context->m_DestroyBufferCb(m_IndexBuffer, m_Context->m_BufferCbUserData);
+        PathDrawEvent evt = {
+            .m_Type        = EVENT_SET_INSTANCES,
+            .m_OffsetStart = m_InstanceTransforms.Size(),
+            .m_OffsetEnd   = m_InstanceTransforms.Size() + count,
+        };
+
+        ensureCapacity(m_InstanceTransforms, evt.m_OffsetEnd);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            m_InstanceTransforms.Push(transforms[i]);
+        }
+
+        m_InstanceStart = evt.m_OffsetStart;
+        m_InstanceCount = count;
+        m_IsInstanced   = count != 1 || memcmp(&transforms[0], &Mat2D::identity(), sizeof(Mat2D)) != 0;
+
+        // The scissor of a rect clip pushed before would limit every instance to the first one
+        assert(!m_IsInstanced || memcmp(m_ClipRect, g_NoClipRect, sizeof(g_NoClipRect)) == 0);
+
+        pushDrawEvent(evt);
+
+        // Applied clips were only drawn for the previous instances
+        if (m_AppliedClips.Size() > 0)
+        {
+            disableClipping();
+        }
     }
 
-    void SharedRenderer::updateIndexBuffer(size_t contourLength)
+    // Bounds are in world space, and miss the cull rect only if they do for every
+    // instance the draws are repeated with.
+    bool SharedRenderer::isBoundsCulled(const float* bounds) const
     {
-        if (contourLength < 2)
+        if (!m_IsCulling)
         {
-            return;
+            return false;
         }
-        uint32_t edgeCount       = (m_Indices.size() - 6) / 3;
-        uint32_t targetEdgeCount = contourLength - 2;
-        if (edgeCount < targetEdgeCount)
+
+        if (!m_IsInstanced)
         {
-            while (edgeCount < targetEdgeCount)
+            return bounds[0] > m_CullRect[2] || bounds[2] < m_CullRect[0] ||
+                   bounds[1] > m_CullRect[3] || bounds[3] < m_CullRect[1];
+        }
+
+        const float corners[] = { bounds[0], bounds[1], bounds[2], bounds[1], bounds[2], bounds[3], bounds[0], bounds[3] };
+        for (uint32_t i = m_InstanceStart; i < m_InstanceStart + m_InstanceCount; ++i)
+        {
+            float transformed[8];
+            float instanceBounds[4] = { FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
+            transformVertices(m_InstanceTransforms[i], corners, transformed, 4, instanceBounds);
+
+            if (instanceBounds[0] <= m_CullRect[2] && instanceBounds[2] >= m_CullRect[0] &&
+                instanceBounds[1] <= m_CullRect[3] && instanceBounds[3] >= m_CullRect[1])
             {
-                m_Indices.push_back(3);
-                m_Indices.push_back(edgeCount + 4);
-                m_Indices.push_back(edgeCount + 5);
-                edgeCount++;
+                return false;
             }
-
-            m_IndexBuffer = m_Context->m_RequestBufferCb(m_IndexBuffer,
-                BUFFER_TYPE_INDEX_BUFFER, &m_Indices[0], m_Indices.size() * sizeof(int),
-                m_Context->m_BufferCbUserData);
         }
+        return true;
     }
 
-    void SharedRenderer::clipPath(RenderPath* path)
+    // Strokes are grown by the full thickness, which leaves room for miter joins
+    // up to a limit of four half widths.
+    bool SharedRenderer::isPathCulled(SharedRenderPath* path, SharedRenderPaint* paint)
     {
-        if (m_ClipPaths.Full())
+        if (!m_IsCulling)
         {
-            m_ClipPaths.SetCapacity(m_ClipPaths.Capacity() + 1);
+            return false;
         }
 
-        m_ClipPaths.Push({.m_Path = path, .m_Transform = m_Transform});
-        m_IsClippingDirty = true;
-    }
+        float bounds[4] = { FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
+        path->addBounds(m_Transform, bounds);
 
-    void SharedRenderer::transform(const Mat2D& transform)
-    {
-        Mat2D::multiply(m_Transform, m_Transform, transform);
+        if (paint->getStyle() == RenderPaintStyle::stroke)
+        {
+            const float sx     = m_Transform[0] * m_Transform[0] + m_Transform[1] * m_Transform[1];
+            const float sy     = m_Transform[2] * m_Transform[2] + m_Transform[3] * m_Transform[3];
+            const float margin = paint->m_StrokeThickness * sqrtf(fmaxf(sx, sy));
+            bounds[0] -= margin;
+            bounds[1] -= margin;
+            bounds[2] += margin;
+            bounds[3] += margin;
+        }
+
+        return isBoundsCulled(bounds);
     }
 
-    void SharedRenderer::save()
+    // Paths are flattened in their own space, so the contour error is divided by the
+    // path's scale on screen. The scale is snapped up to a power of two, a path is only
+    // flattened again once its scale on screen has doubled or halved.
+    float SharedRenderer::getPathContourError(const Mat2D& transform) const
     {
-        StackEntry entry = {};
-        entry.m_Transform = Mat2D(m_Transform);
+        const float sx    = transform[0] * transform[0] + transform[1] * transform[1];
+        const float sy    = transform[2] * transform[2] + transform[3] * transform[3];
+        const float scale = m_ContourScale * sqrtf(fmaxf(sx, sy));
 
-        assert(m_ClipPaths.Size() < STACK_ENTRY_MAX_CLIP_PATHS);
+        int exponent = 0;
+        if (scale > 0.0f && scale < FLT_MAX)
+        {
+            exponent = (int) ceilf(log2f(scale));
+            exponent = exponent < -CONTOUR_SCALE_MAX_EXPONENT ? -CONTOUR_SCALE_MAX_EXPONENT : exponent;
+            exponent = exponent >  CONTOUR_SCALE_MAX_EXPONENT ?  CONTOUR_SCALE_MAX_EXPONENT : exponent;
+        }
 
-        entry.m_ClipPathsCount = m_ClipPaths.Size();
-        memcpy(entry.m_ClipPaths, m_ClipPaths.Begin(), m_ClipPaths.Size() * sizeof(PathDescriptor));
+        return getContourError((HRenderer) this) / ldexpf(1.0f, exponent);
+    }
 
-        if (m_ClipPathStack.Full())
+    void SharedRenderer::pushDrawEvent(PathDrawEvent event)
+    {
+        // Anything recorded after a batched draw has to be ordered after the batch
+        if (event.m_Type != EVENT_DRAW_BATCH)
         {
-            m_ClipPathStack.SetCapacity(m_ClipPathStack.Capacity() + 1);
+            flushBatch();
         }
 
-        m_ClipPathStack.Push(entry);
+        if (m_RecordingFormat == RECORDING_FORMAT_COMMANDS)
+        {
+            pushDrawCommand(event);
+            return;
+        }
+        pushGrow(m_DrawEvents, event);
     }
 
-    void SharedRenderer::restore()
+    void SharedRenderer::pushDrawCommand(const PathDrawEvent& evt)
     {
-        const StackEntry last = m_ClipPathStack.Pop();
-        m_Transform = last.m_Transform;
-        m_ClipPaths.SetSize(0);
-        m_ClipPaths.SetCapacity(last.m_ClipPathsCount);
-        m_IsClippingDirty = true;
+        ensureCapacity(m_DrawCommands, m_DrawCommands.Size() + COMMAND_MAX_SIZE);
 
-        for (int i = 0; i < last.m_ClipPathsCount; ++i)
+        uint8_t* start  = m_DrawCommands.End();
+        uint8_t* p      = start + 1;
+        uint8_t fields  = g_CommandFields[evt.m_Type];
+        uint8_t header  = (uint8_t) evt.m_Type;
+        header         |= evt.m_IsEvenOdd  ? COMMAND_HEADER_EVEN_ODD : 0;
+        header         |= evt.m_IsClipping ? COMMAND_HEADER_CLIPPING : 0;
+
+        if (fields & COMMAND_FIELD_PATH)
         {
-            m_ClipPaths.Push(last.m_ClipPaths[i]);
+            writePointer(p, evt.m_Path);
+        }
+        if (fields & COMMAND_FIELD_PAINT)
+        {
+            writePointer(p, evt.m_Paint);
+            writeVarint(p, evt.m_PaintId);
+        }
+        if (fields & COMMAND_FIELD_OFFSETS)
+        {
+            writeVarint(p, evt.m_OffsetStart);
+            writeVarint(p, evt.m_OffsetEnd);
+        }
+        if (fields & COMMAND_FIELD_IDX)
+        {
+            writeVarint(p, evt.m_Idx);
+        }
+        if (fields & COMMAND_FIELD_CLIP_COUNT)
+        {
+            *p++ = (uint8_t) evt.m_AppliedClipCount;
+        }
+        if (fields & COMMAND_FIELD_TRANSFORMS)
+        {
+            if (evt.m_TransformWorldIdx != m_CommandTransformWorldIdx)
+            {
+                header |= COMMAND_HEADER_WORLD_TRANSFORM;
+                writeVarint(p, evt.m_TransformWorldIdx);
+                m_CommandTransformWorldIdx = evt.m_TransformWorldIdx;
+            }
+            if (evt.m_TransformLocalIdx != m_CommandTransformLocalIdx)
+            {
+                header |= COMMAND_HEADER_LOCAL_TRANSFORM;
+                writeVarint(p, evt.m_TransformLocalIdx);
+                m_CommandTransformLocalIdx = evt.m_TransformLocalIdx;
+            }
         }
+
+        *start = header;
+        m_DrawCommands.SetSize(m_DrawCommands.Size() + (uint32_t) (p - start));
+        m_DrawCommandCount++;
     }
 
-    void SharedRenderer::pushDrawEvent(PathDrawEvent event)
+    void SharedRenderer::resetPaintTable()
+    {
+        m_PaintTable.SetSize(0);
+        m_LastPaintId = 0;
+    }
+
+    uint32_t SharedRenderer::internPaint(const PaintData& data, uint32_t dataHash)
     {
-        if (m_DrawEvents.Full())
+        if (m_PaintTable.Size() > 0 && paintDataEquals(m_PaintTable[m_LastPaintId], data))
         {
-            m_DrawEvents.SetCapacity(m_DrawEvents.Capacity() + 1);
+            return m_LastPaintId;
         }
-        m_DrawEvents.Push(event);
+
+        uint32_t slot   = dataHash & (PAINT_CACHE_SIZE - 1);
+        uint32_t cached = m_PaintCache[slot];
+        if (cached < m_PaintTable.Size() && paintDataEquals(m_PaintTable[cached], data))
+        {
+            m_LastPaintId = cached;
+            return cached;
+        }
+
+        uint32_t id = m_PaintTable.Size();
+        pushGrow(m_PaintTable, data);
+        m_PaintCache[slot] = id;
+        m_LastPaintId      = id;
+        return id;
     }
 
     void SharedRenderer::setPaint(SharedRenderPaint* rp)
@@ -352,9 +2030,12 @@ namespace rive
         {
             m_RenderPaint = rp;
 
+            // The paint pointer is still needed for the stroke buffers, backends
+            // should only look at the id to decide if the paint needs uploading.
             PathDrawEvent evt = {
-                .m_Type  = EVENT_SET_PAINT,
-                .m_Paint = rp,
+                .m_Type    = EVENT_SET_PAINT,
+                .m_Paint   = rp,
+                .m_PaintId = internPaint(rp->m_Data, rp->m_DataHash),
             };
 
             pushDrawEvent(evt);
@@ -399,24 +2080,127 @@ namespace rive
         return pd->m_Data;
     }
 
+    const PaintData* getPaintData(HRenderer renderer, uint32_t paintId)
+    {
+        SharedRenderer* r = (SharedRenderer*) renderer;
+        assert(paintId < r->m_PaintTable.Size());
+        return &r->m_PaintTable[paintId];
+    }
+
     void setContourQuality(HRenderer renderer, float quality)
     {
         SharedRenderer* r   = (SharedRenderer*) renderer;
         r->m_ContourQuality = quality;
     }
 
+    void setContourScale(HRenderer renderer, float scale)
+    {
+        SharedRenderer* r = (SharedRenderer*) renderer;
+        r->m_ContourScale = scale;
+    }
+
+    void setCullRect(HRenderer renderer, float minX, float minY, float maxX, float maxY)
+    {
+        SharedRenderer* r = (SharedRenderer*) renderer;
+        r->m_CullRect[0]  = minX;
+        r->m_CullRect[1]  = minY;
+        r->m_CullRect[2]  = maxX;
+        r->m_CullRect[3]  = maxY;
+        r->m_IsCulling    = true;
+    }
+
+    void clearCullRect(HRenderer renderer)
+    {
+        SharedRenderer* r = (SharedRenderer*) renderer;
+        r->m_IsCulling    = false;
+    }
+
+    bool isCulled(HRenderer renderer, float minX, float minY, float maxX, float maxY)
+    {
+        SharedRenderer* r = (SharedRenderer*) renderer;
+        if (!r->m_IsCulling)
+        {
+            return false;
+        }
+
+        const float corners[] = { minX, minY, maxX, minY, maxX, maxY, minX, maxY };
+        float transformed[8];
+        float bounds[4] = { FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
+        transformVertices(r->m_Transform, corners, transformed, 4, bounds);
+        return r->isBoundsCulled(bounds);
+    }
+
     void setClippingSupport(HRenderer renderer, bool state)
     {
         SharedRenderer* r        = (SharedRenderer*) renderer;
         r->m_IsClippingSupported = state;
     }
 
+    void setClipRetention(HRenderer renderer, bool state)
+    {
+        SharedRenderer* r   = (SharedRenderer*) renderer;
+        r->m_IsClipRetained = state;
+    }
+
+    bool getClipRetention(HRenderer renderer)
+    {
+        SharedRenderer* r = (SharedRenderer*) renderer;
+        return r->m_IsClipRetained;
+    }
+
+    void setBatchingSupport(HRenderer renderer, bool state)
+    {
+        SharedRenderer* r        = (SharedRenderer*) renderer;
+        r->m_IsBatchingSupported = state;
+    }
+
+    bool getBatchingSupport(HRenderer renderer)
+    {
+        SharedRenderer* r = (SharedRenderer*) renderer;
+        return r->m_IsBatchingSupported;
+    }
+
+    void endFrame(HRenderer renderer)
+    {
+        SharedRenderer* r = (SharedRenderer*) renderer;
+        r->endFrame();
+    }
+
+    const DrawBuffers getBatchDrawBuffers(HRenderer renderer)
+    {
+        SharedRenderer* r = (SharedRenderer*) renderer;
+        return { .m_VertexBuffer = r->m_BatchVertexBuffer, .m_IndexBuffer = r->m_BatchIndexBuffer };
+    }
+
+    const BatchRange getBatchRange(HRenderer renderer, const PathDrawEvent& evt)
+    {
+        SharedRenderer* r   = (SharedRenderer*) renderer;
+        uint32_t indexStart = r->m_BatchMeshOffsets[evt.m_OffsetStart];
+        bool isOpaque       = true;
+        for (uint32_t i = evt.m_OffsetStart; i < evt.m_OffsetEnd && isOpaque; ++i)
+        {
+            isOpaque = (r->m_BatchMeshes[i].m_Color >> 24) == 0xff;
+        }
+
+        return {
+            .m_IndexStart = indexStart,
+            .m_IndexCount = r->m_BatchMeshOffsets[evt.m_OffsetEnd] - indexStart,
+            .m_IsOpaque   = isOpaque,
+        };
+    }
+
     void setTransform(HRenderer renderer, const Mat2D& transform)
     {
         SharedRenderer* r = (SharedRenderer*) renderer;
         r->m_Transform = transform;
     }
 
+    void setInstances(HRenderer renderer, const Mat2D* transforms, uint32_t count)
+    {
+        SharedRenderer* r = (SharedRenderer*) renderer;
+        r->setInstances(transforms, count);
+    }
+
     RenderMode getRenderMode(HContext ctx)
     {
         return ((Context*) ctx)->m_RenderMode;
@@ -458,6 +2242,22 @@ namespace rive
         return 0;
     }
 
+    HRenderer createCommandList(HRenderer renderer)
+    {
+        SharedRenderer* r    = (SharedRenderer*) renderer;
+        SharedRenderer* list = (SharedRenderer*) createRenderer((HContext) r->m_Context);
+        list->m_Parent       = r;
+        return (HRenderer) list;
+    }
+
+    void appendCommandList(HRenderer renderer, HRenderer commandList)
+    {
+        SharedRenderer* r    = (SharedRenderer*) renderer;
+        SharedRenderer* list = (SharedRenderer*) commandList;
+        assert(list->m_Parent == r);
+        r->appendCommandList(list);
+    }
+
     void destroyRenderer(HRenderer renderer)
     {
         assert(renderer);
@@ -467,16 +2267,87 @@ namespace rive
     void newFrame(HRenderer renderer)
     {
         SharedRenderer* r = (SharedRenderer*) renderer;
-        r->m_AppliedClips.SetSize(0);
+        if (r->m_Parent)
+        {
+            // Lists are recorded on worker threads, where nothing may be uploaded. Whatever is
+            // left from a list that wasn't appended is dropped, the paths are still dirty and
+            // are queued again when they are drawn.
+            for (uint32_t i = 0; i < r->m_PendingPaths.Size(); ++i)
+            {
+                r->m_PendingPaths[i]->m_IsPending = false;
+            }
+            r->m_PendingPaths.SetSize(0);
+            r->m_PendingStrokes.SetSize(0);
+        }
+        else
+        {
+            // Only has work left if endFrame wasn't called for the last frame
+            r->processPendingPaths();
+            r->m_Context->m_Frame++;
+        }
         r->m_DrawEvents.SetSize(0);
-        r->m_IsClippingDirty = false;
+        r->m_DrawCommands.SetSize(0);
+        r->m_DrawCommandCount         = 0;
+        r->m_CommandTransformWorldIdx = 0;
+        r->m_CommandTransformLocalIdx = 0;
+        r->resetTransformPalette();
+        r->resetPaintTable();
+        r->m_BatchMeshes.SetSize(0);
+        r->m_BatchMeshStart = 0;
+        r->m_InstanceTransforms.SetSize(0);
         r->m_RenderPaint = 0;
         r->m_IsClipping = false;
+        r->m_IsInstanced = false;
+        r->m_InstanceStart = 0;
+        r->m_InstanceCount = 0;
+        memcpy(r->m_AppliedClipRect, g_NoClipRect, sizeof(r->m_AppliedClipRect));
+
+        // Retained clips are only re-enabled, or cleared if the first draw has none
+        if (!r->m_IsClipRetained)
+        {
+            r->m_AppliedClips.SetSize(0);
+        }
+        r->m_IsClippingDirty = r->m_AppliedClips.Size() > 0 || memcmp(r->m_ClipRect, g_NoClipRect, sizeof(g_NoClipRect)) != 0;
+
+        // Command lists pick up the settings of their renderer, and always record
+        // events since they are re-encoded when appended anyway.
+        if (r->m_Parent)
+        {
+            r->m_ContourQuality      = r->m_Parent->m_ContourQuality;
+            r->m_ContourScale        = r->m_Parent->m_ContourScale;
+            r->m_IsClippingSupported = r->m_Parent->m_IsClippingSupported;
+            r->m_IsBatchingSupported = r->m_Parent->m_IsBatchingSupported;
+            r->m_IsCulling           = r->m_Parent->m_IsCulling;
+            memcpy(r->m_CullRect, r->m_Parent->m_CullRect, sizeof(r->m_CullRect));
+            r->m_RecordingFormat     = RECORDING_FORMAT_EVENTS;
+        }
+    }
+
+    void reserveDrawEvents(HRenderer renderer, uint32_t count)
+    {
+        SharedRenderer* r = (SharedRenderer*) renderer;
+        ensureCapacity(r->m_DrawEvents, count);
+    }
+
+    void setRecordingFormat(HRenderer renderer, RecordingFormat format)
+    {
+        SharedRenderer* r    = (SharedRenderer*) renderer;
+        r->m_RecordingFormat = format;
+    }
+
+    RecordingFormat getRecordingFormat(HRenderer renderer)
+    {
+        SharedRenderer* r = (SharedRenderer*) renderer;
+        return r->m_RecordingFormat;
     }
 
     uint32_t getDrawEventCount(HRenderer renderer)
     {
         SharedRenderer* r = (SharedRenderer*) renderer;
+        if (r->m_RecordingFormat == RECORDING_FORMAT_COMMANDS)
+        {
+            return r->m_DrawCommandCount;
+        }
         return r->m_DrawEvents.Size();
     }
 
@@ -486,6 +2357,81 @@ namespace rive
         return r->m_DrawEvents[i];
     }
 
+    const DrawEventList getDrawEvents(HRenderer renderer)
+    {
+        SharedRenderer* r = (SharedRenderer*) renderer;
+        return { .m_Events = r->m_DrawEvents.Begin(), .m_Count = r->m_DrawEvents.Size() };
+    }
+
+    const DrawCommandStream getDrawCommands(HRenderer renderer)
+    {
+        SharedRenderer* r = (SharedRenderer*) renderer;
+        return {
+            .m_Data           = r->m_DrawCommands.Begin(),
+            .m_Transforms     = r->m_TransformPalette.Begin(),
+            .m_Size           = r->m_DrawCommands.Size(),
+            .m_Count          = r->m_DrawCommandCount,
+            .m_TransformCount = r->m_TransformPalette.Size(),
+        };
+    }
+
+    const TransformPalette getTransformPalette(HRenderer renderer)
+    {
+        SharedRenderer* r = (SharedRenderer*) renderer;
+        return { .m_Transforms = r->m_TransformPalette.Begin(), .m_Count = r->m_TransformPalette.Size() };
+    }
+
+    const InstanceList getInstances(HRenderer renderer)
+    {
+        SharedRenderer* r = (SharedRenderer*) renderer;
+        return { .m_Transforms = r->m_InstanceTransforms.Begin(), .m_Count = r->m_InstanceTransforms.Size() };
+    }
+
+    DrawCommandIterator beginDrawCommands(const DrawCommandStream& stream)
+    {
+        return {
+            .m_Cursor     = stream.m_Data,
+            .m_End        = stream.m_Data + stream.m_Size,
+            .m_Event      = {},
+        };
+    }
+
+    bool nextDrawCommand(DrawCommandIterator& it)
+    {
+        if (it.m_Cursor >= it.m_End)
+        {
+            return false;
+        }
+
+        const uint8_t* p    = it.m_Cursor;
+        PathDrawEvent& evt  = it.m_Event;
+        uint8_t header      = *p++;
+        evt.m_Type          = (PathDrawEventType) (header & COMMAND_HEADER_TYPE_MASK);
+        uint8_t fields      = g_CommandFields[evt.m_Type];
+
+        evt.m_Path             = (fields & COMMAND_FIELD_PATH)  ? (HRenderPath) readPointer(p)  : 0;
+        evt.m_Paint            = (fields & COMMAND_FIELD_PAINT) ? (HRenderPaint) readPointer(p) : 0;
+        evt.m_PaintId          = (fields & COMMAND_FIELD_PAINT) ? readVarint(p) : 0;
+        evt.m_OffsetStart      = (fields & COMMAND_FIELD_OFFSETS) ? readVarint(p) : 0;
+        evt.m_OffsetEnd        = (fields & COMMAND_FIELD_OFFSETS) ? readVarint(p) : 0;
+        evt.m_Idx              = (fields & COMMAND_FIELD_IDX) ? readVarint(p) : 0;
+        evt.m_AppliedClipCount = (fields & COMMAND_FIELD_CLIP_COUNT) ? *p++ : 0;
+        evt.m_IsEvenOdd        = (header & COMMAND_HEADER_EVEN_ODD) ? 1 : 0;
+        evt.m_IsClipping       = (header & COMMAND_HEADER_CLIPPING) ? 1 : 0;
+
+        if (header & COMMAND_HEADER_WORLD_TRANSFORM)
+        {
+            evt.m_TransformWorldIdx = readVarint(p);
+        }
+        if (header & COMMAND_HEADER_LOCAL_TRANSFORM)
+        {
+            evt.m_TransformLocalIdx = readVarint(p);
+        }
+
+        it.m_Cursor = p;
+        return true;
+    }
+
     const DrawBuffers getDrawBuffers(HContext ctx, HRenderer renderer, HRenderPath path)
     {
         DrawBuffers buffers  = {};
@@ -506,11 +2452,12 @@ namespace rive
         }
         else if (c->m_RenderMode == MODE_TESSELLATION)
         {
+            // Geometry rebuilt in place keeps the buffers of its last non-empty mesh
             TessellationRenderPath* p = (TessellationRenderPath*) path;
-            if (p)
+            if (p && p->m_Geometry && p->m_Geometry->m_Indices.Size() > 0)
             {
-                buffers.m_IndexBuffer     = p->m_IndexBuffer;
-                buffers.m_VertexBuffer    = p->m_VertexBuffer;
+                buffers.m_IndexBuffer     = p->m_Geometry->m_IndexBuffer;
+                buffers.m_VertexBuffer    = p->m_Geometry->m_VertexBuffer;
             }
         }
 
@@ -518,25 +2465,51 @@ namespace rive
     }
 
 
-    const DrawBuffers getDrawBuffers(HContext ctx, HRenderer renderer, HRenderPaint paint)
+    const DrawBuffers getStrokeDrawBuffers(HRenderer renderer, const PathDrawEvent& evt)
     {
-        Context* c               = (Context*) ctx;
-        SharedRenderPaint* rp    = (SharedRenderPaint*) paint;
-        return { .m_VertexBuffer = rp->m_StrokeBuffer };
+        SharedRenderPath* path   = (SharedRenderPath*) evt.m_Path;
+        return { .m_VertexBuffer = path->m_Strokes[evt.m_Idx].m_Buffer };
     }
 
     void destroyContext(HContext ctx)
     {
         assert(ctx);
-        delete (Context*) ctx;
+        Context* c = (Context*) ctx;
+
+        // Entries are freed with their last path, so any entry left here belongs to a path
+        // that would release it after the context is gone. Paths must be deleted first.
+        assert(c->m_GeometryCache->m_Entries.empty());
+
+        delete c->m_GeometryCache;
+        delete c;
     }
 
-    HContext createContext()
+    HContext createContext(const JobSystem* jobSystem)
     {
-        Context* ctx = new Context;
+        Context* ctx                     = new Context;
+        ctx->m_GeometryCache             = new GeometryCache;
+        ctx->m_GeometryCache->m_IsEnabled = true;
+        ctx->m_JobSystem                 = {};
+        ctx->m_Frame                     = 0;
+        if (jobSystem)
+        {
+            ctx->m_JobSystem = *jobSystem;
+        }
         return (HContext) ctx;
     }
 
+    void setGeometryCaching(HContext ctx, bool state)
+    {
+        Context* c                     = (Context*) ctx;
+        c->m_GeometryCache->m_IsEnabled = state;
+    }
+
+    bool getGeometryCaching(HContext ctx)
+    {
+        Context* c = (Context*) ctx;
+        return c->m_GeometryCache->m_IsEnabled;
+    }
+
     void resetClipping(HRenderer renderer)
     {
         SharedRenderer* r = (SharedRenderer*) renderer;
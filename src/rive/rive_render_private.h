@@ -3,12 +3,44 @@
 
 namespace rive
 {
+    static const uint32_t ARRAY_MIN_CAPACITY = 16;
+
+    // Grows the array geometrically so that at least 'capacity' entries fit.
+    // Capacity is never given back, so once an array has reached its high-water
+    // mark, pushing into it no longer allocates.
+    template <typename T>
+    static inline void ensureCapacity(jc::Array<T>& arr, uint32_t capacity)
+    {
+        if (arr.Capacity() >= capacity)
+        {
+            return;
+        }
+
+        uint32_t newCapacity = arr.Capacity() > ARRAY_MIN_CAPACITY ? arr.Capacity() : ARRAY_MIN_CAPACITY;
+        while (newCapacity < capacity)
+        {
+            newCapacity *= 2;
+        }
+        arr.SetCapacity(newCapacity);
+    }
+
+    template <typename T>
+    static inline void pushGrow(jc::Array<T>& arr, const T& value)
+    {
+        ensureCapacity(arr, arr.Size() + 1);
+        arr.Push(value);
+    }
+
     // TODO: We get compiler warnings when copying this in the arrays, fix it?
     //       -> moving an object of non-trivially copyable type 'struct rive::PathDescriptor' 
     struct PathDescriptor
     {
         RenderPath* m_Path;
         Mat2D       m_Transform;
+        uint32_t    m_Version;
+        // Covers the path, its contour version and transform, chained onto the hash of the
+        // level below. Compared first when matching clip stacks, the fields are checked after.
+        uint32_t    m_Hash;
     };
 
     struct PathLimits
@@ -19,6 +51,14 @@ namespace rive
         float    m_MaxY;
     };
 
+    enum PathVerb
+    {
+        PATH_VERB_MOVE  = 0, // x, y
+        PATH_VERB_LINE  = 1, // x, y
+        PATH_VERB_CUBIC = 2, // out x, out y, in x, in y, x, y
+        PATH_VERB_CLOSE = 3,
+    };
+
     struct GradientStop
     {
         unsigned int m_Color;
@@ -36,16 +76,37 @@ namespace rive
         float                   m_EndY;
     };
 
+    // Tessellated geometry, shared by every path that flattens to the same contours.
+    // The key is the tessellator input: the fill rule, then for each contour its
+    // vertex count followed by the vertices in path space.
+    struct GeometryCacheEntry
+    {
+        jc::Array<float> m_Key;
+        jc::Array<float> m_Vertices;
+        jc::Array<int>   m_Indices;
+        HBuffer          m_VertexBuffer;
+        HBuffer          m_IndexBuffer;
+        uint32_t         m_Hash;
+        uint32_t         m_RefCount;
+        bool             m_IsCached; // Not set on hash collisions, the entry then belongs to one path
+        bool             m_IsUploaded;
+    };
+
+    struct GeometryCache;
     struct Context
     {
         RenderMode      m_RenderMode;
         RequestBufferCb m_RequestBufferCb;
         DestroyBufferCb m_DestroyBufferCb;
         void*           m_BufferCbUserData;
+        JobSystem       m_JobSystem;
+        GeometryCache*  m_GeometryCache;
+        uint32_t        m_Frame; // Counts the newFrame calls of renderers
     };
 
     class SharedRenderer;
     class SharedRenderPath;
+    class TessellationRenderPath;
     class SharedRenderPaint : public RenderPaint
     {
     public:
@@ -68,50 +129,173 @@ namespace rive
 
         Context*                  m_Context;
         SharedRenderPaintBuilder* m_Builder;
-        ContourStroke*            m_Stroke;
-        HBuffer                   m_StrokeBuffer;
         PaintData                 m_Data;
+        uint32_t                  m_DataHash;
         RenderPaintStyle          m_Style;
         float                     m_StrokeThickness;
         StrokeJoin                m_StrokeJoin;
         StrokeCap                 m_StrokeCap;
-        bool                      m_StrokeDirty;
         bool                      m_IsVisible;
     };
 
+    // A stroke extruded from a path, the path keeps one for each set of stroke
+    // parameters it was drawn with recently.
+    struct StrokeCacheEntry
+    {
+        ContourStroke* m_Stroke;
+        HBuffer        m_Buffer;
+        uint32_t       m_ContourVersion;
+        uint32_t       m_LastUsed;
+        uint32_t       m_Frame;
+        float          m_Thickness;
+        StrokeJoin     m_Join;
+        StrokeCap      m_Cap;
+        bool           m_IsExtruded;
+        bool           m_IsUploaded;
+    };
+
     class SharedRenderPath : public ContourRenderPath
     {
     public:
         Context* m_Context;
+        bool     m_IsPending;
+        bool     m_IsFlattenPending;
+
+        // The commands are recorded here as well, fills are flattened by flattenContour
+        // instead of the runtime. Strokes still use the runtime contour.
+        jc::Array<uint8_t> m_Verbs;
+        jc::Array<float>   m_Points;
+        jc::Array<float>   m_Contour;
+        float              m_ContourError;
+        float              m_RequestedError;
+        float              m_LastRequestedError;
+        float              m_SubPathError;
+        uint32_t           m_RequestFrame;
+        uint32_t           m_SubPathFrame;
+        uint32_t           m_ContourVersion;
+        bool               m_IsContourDirty;
+
+        // Control point bounds, as of m_LimitsVersion
+        PathLimits         m_Limits;
+        uint32_t           m_LimitsVersion;
+
+        // Draw events refer to the entries by index, so entries used in the current frame
+        // are never replaced. The cache grows past the limit if all of them are.
+        static const uint32_t       MAX_STROKE_CACHE_ENTRIES = 4;
+        jc::Array<StrokeCacheEntry> m_Strokes;
+        uint32_t                    m_StrokeUseCount;
+
         SharedRenderPath(Context* ctx);
-        void renderStroke(SharedRenderer* renderer, SharedRenderPaint* paint,
-            const Mat2D& transform, const Mat2D& localTransform = Mat2D::identity());
+        ~SharedRenderPath();
+        uint32_t acquireStroke(float thickness, StrokeJoin join, StrokeCap cap);
+        void renderStroke(SharedRenderer* renderer, SharedRenderPaint* paint, SharedRenderPath* strokePath,
+            uint32_t strokeIdx, const Mat2D& transform, const Mat2D& localTransform = Mat2D::identity());
+
+        void reset()                                                           override;
+        void addRenderPath(RenderPath* path, const Mat2D& transform)           override;
+        void moveTo(float x, float y)                                          override;
+        void lineTo(float x, float y)                                          override;
+        void cubicTo(float ox, float oy, float ix, float iy, float x, float y) override;
+        void close()                                                           override;
+
+        void setContourError(float contourError);
+        void requestContourError(float contourError);
+        void requestSubPathContourError(float contourError);
+        bool isContourDirty() const;
+        uint32_t contourVersion() const;
+        void updateContour();
+        void gatherDirtyContours(jc::Array<SharedRenderPath*>& paths);
+        void addBounds(const Mat2D& transform, float* bounds);
+        bool getAxisAlignedRect(const Mat2D& transform, float* rect);
+
+        // Deferred path updates. prepareBuffers and buildBuffers may run on any thread,
+        // resolveBuffers and uploadBuffers always run on the thread that calls endFrame.
+        // resolveBuffers returns true if the path needs buildBuffers to run. The contours
+        // are already flattened when prepareBuffers runs, and must only be read by it.
+        virtual void prepareBuffers() {}
+        virtual bool resolveBuffers() { return false; }
+        virtual void buildBuffers() {}
+        virtual void uploadBuffers(SharedRenderer* renderer) {}
     };
 
     class SharedRenderer : public Renderer
     {
     public:
         static const int STACK_ENTRY_MAX_CLIP_PATHS = 16;
+        static const int TRANSFORM_CACHE_SIZE       = 256;
+        static const int PAINT_CACHE_SIZE           = 64;
+        static const int CONTOUR_SCALE_MAX_EXPONENT = 8;
         struct StackEntry
         {
             Mat2D          m_Transform;
             PathDescriptor m_ClipPaths[STACK_ENTRY_MAX_CLIP_PATHS];
+            float          m_ClipRect[4];
             uint8_t        m_ClipPathsCount;
         };
 
+        // Strokes are found by index at upload, the path's cache may grow until then
+        struct PendingStroke
+        {
+            SharedRenderPath* m_Path;
+            uint32_t          m_Idx;
+        };
+
+        struct BatchMesh
+        {
+            const TessellationRenderPath* m_Path;
+            Mat2D                         m_Transform;
+            uint32_t                      m_Color;
+        };
+
         Context*                  m_Context;
+        SharedRenderer*           m_Parent; // Set for command lists
         std::vector<unsigned int> m_Indices; // todo: use jc::array instead
         jc::Array<StackEntry>     m_ClipPathStack;
         jc::Array<PathDescriptor> m_ClipPaths;
         jc::Array<PathDescriptor> m_AppliedClips;
+        // Axis aligned rectangle clips are intersected into a world space rect that is
+        // applied as a scissor instead of going through the stencil. Unbounded if none.
+        float                     m_ClipRect[4];
+        float                     m_AppliedClipRect[4];
         jc::Array<PathDrawEvent>  m_DrawEvents;
+        jc::Array<uint8_t>        m_DrawCommands;
+        jc::Array<Mat2D>          m_TransformPalette;
+        uint32_t                  m_TransformCache[TRANSFORM_CACHE_SIZE];
+        uint32_t                  m_LastTransformIdx;
+        jc::Array<SharedRenderPath*> m_PendingPaths;
+        jc::Array<SharedRenderPath*> m_BuildPaths;
+        jc::Array<SharedRenderPath*> m_FlattenPaths;
+        jc::Array<PendingStroke>     m_PendingStrokes;
+        jc::Array<BatchMesh>      m_BatchMeshes;
+        jc::Array<uint32_t>       m_BatchMeshOffsets;
+        jc::Array<BatchVertex>    m_BatchVertices;
+        jc::Array<uint32_t>       m_BatchIndices;
+        HBuffer                   m_BatchVertexBuffer;
+        HBuffer                   m_BatchIndexBuffer;
+        uint32_t                  m_BatchMeshStart;
+        jc::Array<Mat2D>          m_InstanceTransforms;
+        uint32_t                  m_InstanceStart;
+        uint32_t                  m_InstanceCount;
+        float                     m_CullRect[4];
+        jc::Array<PaintData>      m_PaintTable;
+        uint32_t                  m_PaintCache[PAINT_CACHE_SIZE];
+        uint32_t                  m_LastPaintId;
+        uint32_t                  m_CommandTransformWorldIdx;
+        uint32_t                  m_CommandTransformLocalIdx;
+        uint32_t                  m_DrawCommandCount;
+        RecordingFormat           m_RecordingFormat;
         Mat2D                     m_Transform;
         SharedRenderPaint*        m_RenderPaint;
         HBuffer                   m_IndexBuffer;
         float                     m_ContourQuality;
+        float                     m_ContourScale;
         uint8_t                   m_IsClippingDirty     : 1;
         uint8_t                   m_IsClipping          : 1;
         uint8_t                   m_IsClippingSupported : 1;
+        uint8_t                   m_IsBatchingSupported : 1;
+        uint8_t                   m_IsClipRetained      : 1;
+        uint8_t                   m_IsInstanced         : 1;
+        uint8_t                   m_IsCulling           : 1;
 
         SharedRenderer();
         ~SharedRenderer();
@@ -122,6 +306,30 @@ namespace rive
         void startFrame();
 
         void pushDrawEvent(PathDrawEvent evt);
+        void pushDrawCommand(const PathDrawEvent& evt);
+        uint32_t internTransform(const Mat2D& transform);
+        void resetTransformPalette();
+        uint32_t internPaint(const PaintData& data, uint32_t dataHash);
+        void resetPaintTable();
+        bool defersPathUpdates() const;
+        void queuePath(SharedRenderPath* path);
+        void queueStroke(SharedRenderPath* path, uint32_t strokeIdx);
+        void processPendingPaths();
+        void batchMesh(const TessellationRenderPath* path, const Mat2D& transform, const PaintData& paint);
+        void buildBatches();
+        void flushBatch();
+        void endFrame();
+        void appendCommandList(SharedRenderer* list);
+        bool isClipStackEqual(const PathDescriptor* clipPaths, uint32_t count) const;
+        uint32_t getAppliedClipPrefix() const;
+        void pushClippingBegin(uint32_t level, uint32_t popLevel, uint32_t first);
+        void setAppliedClips();
+        void setAppliedClipRect(const float* rect);
+        virtual void disableClipping();
+        void setInstances(const Mat2D* transforms, uint32_t count);
+        bool isBoundsCulled(const float* bounds) const;
+        bool isPathCulled(SharedRenderPath* path, SharedRenderPaint* paint);
+        float getPathContourError(const Mat2D& transform) const;
         void setPaint(SharedRenderPaint* rp);
         void updateIndexBuffer(size_t contourLength);
     };
@@ -146,6 +354,7 @@ namespace rive
         void drawPath(RenderPath* path, RenderPaint* paint) override;
         void applyClipping();
         void applyClipPath(StencilToCoverRenderPath* path, const Mat2D& transform);
+        void disableClipping() override;
     };
 
     class StencilToCoverRenderPath : public SharedRenderPath
@@ -160,6 +369,7 @@ namespace rive
         void stencil(SharedRenderer* renderer, const Mat2D& transform, unsigned int idx, bool isEvenOdd, bool isClipping);
         void cover(SharedRenderer* renderer, const Mat2D transform, const Mat2D transformLocal, bool isClipping);
         void updateBuffers(SharedRenderer* renderer);
+        void uploadBuffers(SharedRenderer* renderer) override;
         void fillRule(FillRule value) override;
         FillRule fillRule() const { return m_FillRule; }
 
@@ -175,19 +385,25 @@ namespace rive
         TessellationRenderer(Context* ctx);
         void drawPath(RenderPath* path, RenderPaint* paint) override;
         void applyClipping();
+        void pushClipPath(const PathDescriptor& pd);
+        void disableClipping() override;
     };
 
     class TessellationRenderPath : public SharedRenderPath
     {
     public:
-        FillRule m_FillRule;
-        float    m_ContourError;
-        HBuffer  m_VertexBuffer;
-        HBuffer  m_IndexBuffer;
+        FillRule            m_FillRule;
+        jc::Array<float>    m_GeometryKey;
+        uint32_t            m_GeometryHash;
+        GeometryCacheEntry* m_Geometry;
+        float               m_Bounds[4];
 
-        void addContours(void* tess, const Mat2D& m);
-        void updateContour();
+        void addContours(jc::Array<float>& key, float* bounds, const Mat2D& m);
         void updateTesselation();
+        void prepareBuffers() override;
+        bool resolveBuffers() override;
+        void buildBuffers() override;
+        void uploadBuffers(SharedRenderer* renderer) override;
 
         TessellationRenderPath(Context* ctx);
         ~TessellationRenderPath();
@@ -199,17 +415,16 @@ namespace rive
     ////////////////////////////////////////////////////
     // Helper Functions
     ////////////////////////////////////////////////////
-    void segmentCubic(const Vec2D& from,
-                      const Vec2D& fromOut,
-                      const Vec2D& toIn,
-                      const Vec2D& to,
-                      float t1,
-                      float t2,
-                      float minSegmentLength,
-                      float distTooFar,
-                      float* vertices,
-                      uint32_t& verticesCount,
-                      PathLimits* pathLimits);
+    uint32_t            hashGeometryKey(const jc::Array<float>& key);
+    GeometryCacheEntry* acquireGeometry(Context* ctx, GeometryCacheEntry* previous,
+                                        const jc::Array<float>& key, uint32_t hash, bool& needsBuild);
+    void                releaseGeometry(Context* ctx, GeometryCacheEntry* entry);
+    bool                triangulateSimpleContour(GeometryCacheEntry* geometry);
+    void                tessellateContours(GeometryCacheEntry* geometry);
+    void                transformVertices(const Mat2D& m, const float* in, float* out, uint32_t count, float* bounds);
+    void                uploadStroke(Context* ctx, StrokeCacheEntry* stroke);
+    void                flattenContour(const uint8_t* verbs, uint32_t verbCount, const float* points,
+                                       float tolerance, jc::Array<float>& contour);
 }
 
 #endif
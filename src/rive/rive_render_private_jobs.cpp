@@ -0,0 +1,162 @@
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <rive/renderer.hpp>
+
+#include "rive/rive_render_api.h"
+
+namespace rive
+{
+    ////////////////////////////////////////////////////////
+    // Thread pool
+    ////////////////////////////////////////////////////////
+
+    // One group of jobs is in flight at a time. Workers and the thread that
+    // waits for the group all pull job indices from the same counter. A new
+    // group is only set up once no worker is running jobs from the last one.
+    struct ThreadPool
+    {
+        std::vector<std::thread> m_Threads;
+        std::mutex               m_Mutex;
+        std::condition_variable  m_WorkCondition;
+        std::condition_variable  m_DoneCondition;
+        JobFunction              m_Function;
+        void*                    m_JobData;
+        uint32_t                 m_JobCount;
+        std::atomic<uint32_t>    m_NextJob;
+        std::atomic<uint32_t>    m_JobsLeft;
+        uint32_t                 m_Generation;
+        uint32_t                 m_ActiveWorkers;
+        bool                     m_Quit;
+    };
+
+    static void runJobs(ThreadPool* pool, JobFunction fn, void* jobData, uint32_t jobCount)
+    {
+        while (true)
+        {
+            uint32_t jobIndex = pool->m_NextJob.fetch_add(1);
+            if (jobIndex >= jobCount)
+            {
+                break;
+            }
+
+            fn(jobData, jobIndex);
+            pool->m_JobsLeft.fetch_sub(1);
+        }
+    }
+
+    static void workerThread(ThreadPool* pool)
+    {
+        uint32_t generation = 0;
+        while (true)
+        {
+            JobFunction fn;
+            void*       jobData;
+            uint32_t    jobCount;
+
+            {
+                std::unique_lock<std::mutex> lock(pool->m_Mutex);
+                pool->m_WorkCondition.wait(lock, [&] { return pool->m_Quit || pool->m_Generation != generation; });
+                if (pool->m_Quit)
+                {
+                    return;
+                }
+                generation = pool->m_Generation;
+                fn         = pool->m_Function;
+                jobData    = pool->m_JobData;
+                jobCount   = pool->m_JobCount;
+                pool->m_ActiveWorkers++;
+            }
+
+            runJobs(pool, fn, jobData, jobCount);
+
+            std::lock_guard<std::mutex> lock(pool->m_Mutex);
+            pool->m_ActiveWorkers--;
+            pool->m_DoneCondition.notify_all();
+        }
+    }
+
+    static void threadPoolSubmit(JobFunction fn, void* jobData, uint32_t jobCount, void* userData)
+    {
+        ThreadPool* pool = (ThreadPool*) userData;
+        std::unique_lock<std::mutex> lock(pool->m_Mutex);
+        pool->m_DoneCondition.wait(lock, [&] { return pool->m_ActiveWorkers == 0; });
+        pool->m_Function = fn;
+        pool->m_JobData  = jobData;
+        pool->m_JobCount = jobCount;
+        pool->m_NextJob  = 0;
+        pool->m_JobsLeft = jobCount;
+        pool->m_Generation++;
+        pool->m_WorkCondition.notify_all();
+    }
+
+    static void threadPoolWait(void* userData)
+    {
+        ThreadPool* pool = (ThreadPool*) userData;
+        runJobs(pool, pool->m_Function, pool->m_JobData, pool->m_JobCount);
+
+        std::unique_lock<std::mutex> lock(pool->m_Mutex);
+        pool->m_DoneCondition.wait(lock, [&] { return pool->m_JobsLeft == 0; });
+    }
+
+    HThreadPool createThreadPool(uint32_t threadCount)
+    {
+        if (threadCount == 0)
+        {
+            uint32_t cores = std::thread::hardware_concurrency();
+            threadCount    = cores > 1 ? cores - 1 : 0;
+        }
+
+        ThreadPool* pool      = new ThreadPool;
+        pool->m_Function      = 0;
+        pool->m_JobData       = 0;
+        pool->m_JobCount      = 0;
+        pool->m_NextJob       = 0;
+        pool->m_JobsLeft      = 0;
+        pool->m_Generation    = 0;
+        pool->m_ActiveWorkers = 0;
+        pool->m_Quit          = false;
+
+        pool->m_Threads.reserve(threadCount);
+        for (uint32_t i = 0; i < threadCount; ++i)
+        {
+            pool->m_Threads.emplace_back(workerThread, pool);
+        }
+
+        return (HThreadPool) pool;
+    }
+
+    void destroyThreadPool(HThreadPool handle)
+    {
+        ThreadPool* pool = (ThreadPool*) handle;
+        if (pool == 0)
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(pool->m_Mutex);
+            pool->m_Quit = true;
+            pool->m_WorkCondition.notify_all();
+        }
+
+        for (size_t i = 0; i < pool->m_Threads.size(); ++i)
+        {
+            pool->m_Threads[i].join();
+        }
+
+        delete pool;
+    }
+
+    const JobSystem getJobSystem(HThreadPool pool)
+    {
+        return {
+            .m_SubmitCb = threadPoolSubmit,
+            .m_WaitCb   = threadPoolWait,
+            .m_UserData = (void*) pool,
+        };
+    }
+}
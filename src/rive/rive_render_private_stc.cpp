@@ -22,7 +22,7 @@ namespace rive
     {
         SharedRenderPaint::drawPaint(renderer, transform, path);
 
-        if (m_Stroke == 0)
+        if (m_Style != RenderPaintStyle::stroke)
         {
             StencilToCoverRenderPath* rp = (StencilToCoverRenderPath*) path;
             rp->cover(renderer, renderer->m_Transform, Mat2D(), renderer->m_IsClipping);
@@ -55,58 +55,50 @@ namespace rive
         }
     }
 
+    // The clip is a single stencil bit, so clip paths pushed on top of the applied ones
+    // are intersected with it in place. Popping a clip path can't be undone on the bit,
+    // the stencil is then cleared and the whole stack applied again.
     void StencilToCoverRenderer::applyClipping()
     {
         m_IsClippingDirty = false;
-        bool same = true;
-        if (m_ClipPaths.Size() == m_AppliedClips.Size())
-        {
-            for (int i = 0; i < (int) m_ClipPaths.Size(); ++i)
-            {
-                const PathDescriptor& pdA = m_ClipPaths[i];
-                const PathDescriptor& pdB = m_AppliedClips[i];
-
-                if (pdA.m_Path != pdB.m_Path || (pdA.m_Transform == pdB.m_Transform))
-                {
-                    same = false;
-                    break;
-                }
-            }
-        }
-        else
-        {
-            same = false;
-        }
+        setAppliedClipRect(m_ClipRect);
 
-        if (same)
+        const uint32_t prefix = getAppliedClipPrefix();
+        if (prefix == m_ClipPaths.Size() && prefix == m_AppliedClips.Size() && m_IsClipping == (prefix > 0))
         {
             return;
         }
 
-        m_IsClipping = false;
+        const uint32_t first = (prefix > 0 && prefix == m_AppliedClips.Size()) ? prefix : 0;
+        m_IsClipping         = first > 0;
+        pushClippingBegin(first, first, first);
+
+        for (uint32_t i = first; i < m_ClipPaths.Size(); ++i)
+        {
+            const PathDescriptor& pd = m_ClipPaths[i];
+            applyClipPath((StencilToCoverRenderPath*) pd.m_Path, pd.m_Transform);
+        }
 
-        PathDrawEvent evt = { .m_Type = EVENT_CLIPPING_BEGIN };
+        PathDrawEvent evt = {
+            .m_Type             = EVENT_CLIPPING_END,
+            .m_AppliedClipCount = (uint32_t) m_ClipPaths.Size(),
+        };
         pushDrawEvent(evt);
+        setAppliedClips();
+    }
 
-        if (m_ClipPaths.Size() > 0)
+    // Fills that don't clip would count the clip bit into their winding, so it is
+    // cleared right away instead of on the next clip change.
+    void StencilToCoverRenderer::disableClipping()
+    {
+        if (m_AppliedClips.Size() > 0)
         {
-            for (int i = 0; i < (int) m_ClipPaths.Size(); ++i)
-            {
-                const PathDescriptor& pd = m_ClipPaths[i];
-                applyClipPath((StencilToCoverRenderPath*) pd.m_Path, pd.m_Transform);
-            }
+            pushClippingBegin(0, 0, m_ClipPaths.Size());
 
-            m_AppliedClips.SetCapacity(m_ClipPaths.Capacity());
-            m_AppliedClips.SetSize(0);
-
-            for (int i = 0; i < (int) m_ClipPaths.Size(); ++i)
-            {
-                m_AppliedClips.Push(m_ClipPaths[i]);
-            }
+            PathDrawEvent evt = { .m_Type = EVENT_CLIPPING_END };
+            pushDrawEvent(evt);
         }
-
-        evt.m_Type = EVENT_CLIPPING_END;
-        pushDrawEvent(evt);
+        SharedRenderer::disableClipping();
     }
 
     void StencilToCoverRenderer::applyClipPath(StencilToCoverRenderPath* path, const Mat2D& transform)
@@ -116,14 +108,11 @@ namespace rive
 
         if (m_IsClipping)
         {
-            Mat2D identityTransform;
-
+            // Palette entry 0 is the identity transform
             PathDrawEvent evt = {
-                .m_Type           = EVENT_DRAW_COVER,
-                .m_Path           = m_FullscreenPath,
-                .m_TransformWorld = identityTransform,
-                .m_TransformLocal = identityTransform,
-                .m_IsClipping     = m_IsClipping,
+                .m_Type       = EVENT_DRAW_COVER,
+                .m_Path       = m_FullscreenPath,
+                .m_IsClipping = m_IsClipping,
             };
             pushDrawEvent(evt);
         }
@@ -141,7 +130,7 @@ namespace rive
         SharedRenderPath*       srph = (SharedRenderPath*) path;
         SharedRenderPaint*       rp  = (SharedRenderPaint*) paint;
 
-        if (!rp->isVisible())
+        if (!rp->isVisible() || isPathCulled(srph, rp))
         {
             return;
         }
@@ -177,10 +166,15 @@ namespace rive
 
     void StencilToCoverRenderPath::updateBuffers(SharedRenderer* renderer)
     {
-        std::size_t vertexCount = m_ContourVertices.size();
+        std::size_t vertexCount = m_Contour.Size() / 2;
         renderer->updateIndexBuffer(vertexCount - 3);
         m_VertexBuffer = renderer->m_Context->m_RequestBufferCb(m_VertexBuffer,
-            BUFFER_TYPE_VERTEX_BUFFER, &m_ContourVertices[0][0], vertexCount * sizeof(float) * 2.0f, renderer->m_Context->m_BufferCbUserData);
+            BUFFER_TYPE_VERTEX_BUFFER, m_Contour.Begin(), vertexCount * sizeof(float) * 2.0f, renderer->m_Context->m_BufferCbUserData);
+    }
+
+    void StencilToCoverRenderPath::uploadBuffers(SharedRenderer* renderer)
+    {
+        updateBuffers(renderer);
     }
 
     void StencilToCoverRenderPath::stencil(SharedRenderer* renderer, const Mat2D& transform, unsigned int idx, bool isEvenOdd, bool isClipping)
@@ -197,19 +191,28 @@ namespace rive
             return;
         }
 
-        if (isDirty())
+        requestContourError(renderer->getPathContourError(transform));
+
+        if (m_IsContourDirty)
         {
-            computeContour();
-            updateBuffers(renderer);
+            if (!renderer->defersPathUpdates())
+            {
+                updateContour();
+                updateBuffers(renderer);
+            }
+            else
+            {
+                renderer->queuePath(this);
+            }
         }
 
         PathDrawEvent evt = {
-            .m_Type           = EVENT_DRAW_STENCIL,
-            .m_Path           = this,
-            .m_TransformWorld = transform,
-            .m_Idx            = idx,
-            .m_IsEvenOdd      = isEvenOdd,
-            .m_IsClipping     = isClipping,
+            .m_Type              = EVENT_DRAW_STENCIL,
+            .m_Path              = this,
+            .m_TransformWorldIdx = renderer->internTransform(transform),
+            .m_Idx               = idx,
+            .m_IsEvenOdd         = isEvenOdd,
+            .m_IsClipping        = isClipping,
         };
 
         renderer->pushDrawEvent(evt);
@@ -231,11 +234,11 @@ namespace rive
         }
 
         PathDrawEvent evt = {
-            .m_Type           = EVENT_DRAW_COVER,
-            .m_Path           = this,
-            .m_TransformWorld = transform,
-            .m_TransformLocal = transformLocal,
-            .m_IsClipping     = isClipping,
+            .m_Type              = EVENT_DRAW_COVER,
+            .m_Path              = this,
+            .m_TransformWorldIdx = renderer->internTransform(transform),
+            .m_TransformLocalIdx = renderer->internTransform(transformLocal),
+            .m_IsClipping        = isClipping,
         };
 
         renderer->pushDrawEvent(evt);
@@ -1,4 +1,6 @@
 #include <float.h>
+#include <math.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <jc/array.h>
@@ -16,108 +18,426 @@
 namespace rive
 {
     ////////////////////////////////////////////////////////
-    // Tessellation - RenderPath
+    // Tessellation - Arena allocator
     ////////////////////////////////////////////////////////
 
-    TessellationRenderPath::TessellationRenderPath(Context* ctx)
-    : SharedRenderPath(ctx)
-    , m_VertexBuffer(0)
-    , m_IndexBuffer(0)
-    {}
+    static const uint32_t ARENA_CHUNK_SIZE  = 256 * 1024;
+    static const uint32_t ARENA_ALIGNMENT   = 16;
+    // Every allocation is prefixed with its size so it can be reallocated
+    static const uint32_t ARENA_HEADER_SIZE = ARENA_ALIGNMENT;
 
-    TessellationRenderPath::~TessellationRenderPath()
+    struct ArenaChunk
+    {
+        ArenaChunk* m_Next;
+        uint32_t    m_Size;
+        uint32_t    m_Used;
+    };
+
+    // libtess2 allocates all of its mesh structures through TESSalloc. Each thread
+    // bump allocates them from a list of chunks that is reset before every path,
+    // and the chunks are kept, so once the largest path has been seen tessellating
+    // no longer touches the heap. Nothing is ever freed individually.
+    struct TessArena
     {
-        m_Context->m_DestroyBufferCb(m_VertexBuffer, m_Context->m_BufferCbUserData);
-        m_Context->m_DestroyBufferCb(m_IndexBuffer, m_Context->m_BufferCbUserData);
+        ArenaChunk* m_First;
+        ArenaChunk* m_Current;
+        TESSalloc   m_Alloc;
+
+        TessArena();
+        ~TessArena();
+        void reset();
+    };
+
+    static inline uint32_t alignArena(uint32_t size)
+    {
+        return (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
     }
 
-    void TessellationRenderPath::fillRule(FillRule value)
+    static ArenaChunk* newArenaChunk(uint32_t dataSize)
     {
-        m_FillRule = value;
+        ArenaChunk* chunk = (ArenaChunk*) malloc(alignArena(sizeof(ArenaChunk)) + dataSize);
+        chunk->m_Next     = 0;
+        chunk->m_Size     = dataSize;
+        chunk->m_Used     = 0;
+        return chunk;
     }
 
-    void TessellationRenderPath::addContours(void* tess, const Mat2D& m)
+    static void* arenaAlloc(void* userData, unsigned int size)
     {
-        if (isContainer())
+        TessArena* arena  = (TessArena*) userData;
+        uint32_t needed   = alignArena(size) + ARENA_HEADER_SIZE;
+        ArenaChunk* chunk = arena->m_Current;
+
+        // Chunks after the current one are empty, but may be too small for this
+        while (chunk->m_Used + needed > chunk->m_Size)
         {
-            for (int i = 0; i < (int) m_SubPaths.size(); ++i)
+            if (chunk->m_Next == 0)
             {
-                TessellationRenderPath* sharedPath = (TessellationRenderPath*) m_SubPaths[i].path();
-                sharedPath->addContours(tess, m_SubPaths[i].transform());
+                chunk->m_Next = newArenaChunk(needed > ARENA_CHUNK_SIZE ? needed : ARENA_CHUNK_SIZE);
             }
-            return;
+            chunk = chunk->m_Next;
         }
 
-        const int numComponents = 2;
-        const int stride        = sizeof(float) * numComponents;
+        uint8_t* p = (uint8_t*) chunk + alignArena(sizeof(ArenaChunk)) + chunk->m_Used;
+        *(uint32_t*) p   = size;
+        chunk->m_Used   += needed;
+        arena->m_Current = chunk;
+        return p + ARENA_HEADER_SIZE;
+    }
 
-        Mat2D identity;
-        if (identity == m)
+    static void* arenaRealloc(void* userData, void* ptr, unsigned int size)
+    {
+        void* p = arenaAlloc(userData, size);
+        if (ptr)
         {
-            tessAddContour((TESStesselator*)tess, numComponents, &m_ContourVertices[4][0], stride, m_ContourVertices.size());
+            uint32_t oldSize = *(uint32_t*) ((uint8_t*) ptr - ARENA_HEADER_SIZE);
+            memcpy(p, ptr, oldSize < size ? oldSize : size);
         }
-        else
+        return p;
+    }
+
+    static void arenaFree(void* userData, void* ptr)
+    {}
+
+    TessArena::TessArena()
+    {
+        m_First   = newArenaChunk(ARENA_CHUNK_SIZE);
+        m_Current = m_First;
+        m_Alloc   = {
+            .memalloc      = arenaAlloc,
+            .memrealloc    = arenaRealloc,
+            .memfree       = arenaFree,
+            .userData      = this,
+            .extraVertices = 256,
+        };
+    }
+
+    TessArena::~TessArena()
+    {
+        ArenaChunk* chunk = m_First;
+        while (chunk)
         {
-            const float m0 = m[0];
-            const float m1 = m[1];
-            const float m2 = m[2];
-            const float m3 = m[3];
-            const float m4 = m[4];
-            const float m5 = m[5];
+            ArenaChunk* next = chunk->m_Next;
+            free(chunk);
+            chunk = next;
+        }
+    }
+
+    void TessArena::reset()
+    {
+        for (ArenaChunk* chunk = m_First; chunk; chunk = chunk->m_Next)
+        {
+            chunk->m_Used = 0;
+        }
+        m_Current = m_First;
+    }
 
-            float transformBuffer[512 * numComponents]; // todo: dynamic array
+    // Paths are tessellated on the job system's threads, one arena per thread
+    static thread_local TessArena g_TessArena;
 
-            rive::Vec2D* contourVertices = &m_ContourVertices[4];
-            int numContours              = m_ContourVertices.size() - 4;
+    ////////////////////////////////////////////////////////
+    // Tessellation - Triangulation
+    ////////////////////////////////////////////////////////
 
-            for (int i = 0; i < numContours; i++)
+    // Ear clipping is quadratic, larger simple contours go to libtess2
+    static const int EAR_CLIP_MAX_VERTICES = 64;
+
+    enum ContourClass
+    {
+        CONTOUR_CLASS_DEGENERATE = 0,
+        CONTOUR_CLASS_CONVEX     = 1,
+        CONTOUR_CLASS_CONCAVE    = 2,
+    };
+
+    static inline float cross(const float* o, const float* a, const float* b)
+    {
+        return (a[0] - o[0]) * (b[1] - o[1]) - (a[1] - o[1]) * (b[0] - o[0]);
+    }
+
+    static inline int signOf(float v)
+    {
+        return v > 0.0f ? 1 : (v < 0.0f ? -1 : 0);
+    }
+
+    // Convex means every corner turns the same way, the contour never doubles back
+    // and it only winds once, i.e the edges change horizontal direction twice.
+    static ContourClass classifyContour(const float* v, int n)
+    {
+        int turn       = 0;
+        int flips      = 0;
+        int firstDx    = 0;
+        int lastDx     = 0;
+        bool isConvex  = true;
+
+        for (int i = 0; i < n; ++i)
+        {
+            const float* a = &v[i * 2];
+            const float* b = &v[((i + 1) % n) * 2];
+            const float* c = &v[((i + 2) % n) * 2];
+
+            int s = signOf(cross(a, b, c));
+            if (s == 0)
+            {
+                float dot = (b[0] - a[0]) * (c[0] - b[0]) + (b[1] - a[1]) * (c[1] - b[1]);
+                isConvex  = isConvex && dot >= 0.0f;
+            }
+            else if (turn == 0)
+            {
+                turn = s;
+            }
+            else if (s != turn)
             {
-                float x                  = contourVertices[i][0];
-                float y                  = contourVertices[i][1];
-                transformBuffer[i*2    ] = m0 * x + m2 * y + m4;
-                transformBuffer[i*2 + 1] = m1 * x + m3 * y + m5;
+                isConvex = false;
             }
 
-            tessAddContour((TESStesselator*) tess, numComponents, transformBuffer, stride, numContours);
+            int dx = signOf(b[0] - a[0]);
+            if (dx != 0)
+            {
+                flips  += (lastDx != 0 && dx != lastDx) ? 1 : 0;
+                firstDx = firstDx != 0 ? firstDx : dx;
+                lastDx  = dx;
+            }
+        }
+
+        if (turn == 0)
+        {
+            return CONTOUR_CLASS_DEGENERATE;
         }
+
+        flips += firstDx != lastDx ? 1 : 0;
+        return isConvex && flips <= 2 ? CONTOUR_CLASS_CONVEX : CONTOUR_CLASS_CONCAVE;
     }
 
-    void TessellationRenderPath::updateContour()
+    static inline bool onSegment(const float* a, const float* b, const float* p)
     {
-        if (isContainer())
+        return p[0] >= fminf(a[0], b[0]) && p[0] <= fmaxf(a[0], b[0])
+            && p[1] >= fminf(a[1], b[1]) && p[1] <= fmaxf(a[1], b[1]);
+    }
+
+    // Touching and collinear overlaps count as intersections, those are left to libtess2
+    static bool segmentsIntersect(const float* a, const float* b, const float* c, const float* d)
+    {
+        if (fmaxf(a[0], b[0]) < fminf(c[0], d[0]) || fmaxf(c[0], d[0]) < fminf(a[0], b[0]) ||
+            fmaxf(a[1], b[1]) < fminf(c[1], d[1]) || fmaxf(c[1], d[1]) < fminf(a[1], b[1]))
         {
-            for (int i = 0; i < (int) m_SubPaths.size(); ++i)
+            return false;
+        }
+
+        float d1 = cross(c, d, a);
+        float d2 = cross(c, d, b);
+        float d3 = cross(a, b, c);
+        float d4 = cross(a, b, d);
+
+        if (((d1 > 0.0f && d2 < 0.0f) || (d1 < 0.0f && d2 > 0.0f)) &&
+            ((d3 > 0.0f && d4 < 0.0f) || (d3 < 0.0f && d4 > 0.0f)))
+        {
+            return true;
+        }
+
+        return (d1 == 0.0f && onSegment(c, d, a)) || (d2 == 0.0f && onSegment(c, d, b))
+            || (d3 == 0.0f && onSegment(a, b, c)) || (d4 == 0.0f && onSegment(a, b, d));
+    }
+
+    static bool isSimpleContour(const float* v, int n)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            const float* a = &v[i * 2];
+            const float* b = &v[((i + 1) % n) * 2];
+
+            // Skip the edges that share a vertex with edge i
+            for (int j = i + 2; j < n; ++j)
             {
-                TessellationRenderPath* sharedPath = (TessellationRenderPath*) m_SubPaths[i].path();
-                sharedPath->updateContour();
+                if (i == 0 && j == n - 1)
+                {
+                    continue;
+                }
+
+                if (segmentsIntersect(a, b, &v[j * 2], &v[((j + 1) % n) * 2]))
+                {
+                    return false;
+                }
             }
         }
+        return true;
+    }
 
-        if (isDirty())
+    static bool earClip(const float* v, int n, jc::Array<int>& indices)
+    {
+        int remaining[EAR_CLIP_MAX_VERTICES];
+        int count = n;
+        for (int i = 0; i < n; ++i)
         {
-            computeContour();
+            remaining[i] = i;
         }
+
+        float area = 0.0f;
+        for (int i = 0; i < n; ++i)
+        {
+            area += cross(&v[0], &v[i * 2], &v[((i + 1) % n) * 2]);
+        }
+        const float orientation = area > 0.0f ? 1.0f : -1.0f;
+
+        ensureCapacity(indices, (n - 2) * 3);
+
+        while (count > 3)
+        {
+            bool foundEar = false;
+            for (int i = 0; i < count && !foundEar; ++i)
+            {
+                const int ia   = remaining[(i + count - 1) % count];
+                const int ib   = remaining[i];
+                const int ic   = remaining[(i + 1) % count];
+                const float* a = &v[ia * 2];
+                const float* b = &v[ib * 2];
+                const float* c = &v[ic * 2];
+
+                if (cross(a, b, c) * orientation <= 0.0f)
+                {
+                    continue;
+                }
+
+                bool isEar = true;
+                for (int j = 0; j < count && isEar; ++j)
+                {
+                    const int ip = remaining[j];
+                    if (ip == ia || ip == ib || ip == ic)
+                    {
+                        continue;
+                    }
+
+                    const float* p = &v[ip * 2];
+                    isEar = !(cross(a, b, p) * orientation >= 0.0f &&
+                              cross(b, c, p) * orientation >= 0.0f &&
+                              cross(c, a, p) * orientation >= 0.0f);
+                }
+
+                if (isEar)
+                {
+                    indices.Push(ia);
+                    indices.Push(ib);
+                    indices.Push(ic);
+                    memmove(&remaining[i], &remaining[i + 1], (count - i - 1) * sizeof(int));
+                    count--;
+                    foundEar = true;
+                }
+            }
+
+            // Precision issues, let libtess2 deal with it
+            if (!foundEar)
+            {
+                return false;
+            }
+        }
+
+        indices.Push(remaining[0]);
+        indices.Push(remaining[1]);
+        indices.Push(remaining[2]);
+        return true;
     }
 
-    void TessellationRenderPath::updateTesselation()
+    // A single contour that doesn't intersect itself covers the same area with both
+    // fill rules, so it can be triangulated directly. Convex contours become a fan,
+    // small concave ones are ear clipped. Returns false if libtess2 is needed.
+    bool triangulateSimpleContour(GeometryCacheEntry* geometry)
     {
-        if (!isDirty())
+        const float* key  = geometry->m_Key.Begin();
+        const uint32_t keySize = geometry->m_Key.Size();
+        if (keySize < 2 || keySize != 2 + (uint32_t) key[1] * 2)
         {
-            return;
+            return false;
         }
 
-        updateContour();
+        const int numContourVertices = (int) key[1];
+        const float* contour         = &key[2];
+
+        // Drop repeated vertices, including the closing one
+        jc::Array<float>& vertices = geometry->m_Vertices;
+        vertices.SetSize(0);
+        ensureCapacity(vertices, numContourVertices * 2);
+        for (int i = 0; i < numContourVertices; ++i)
+        {
+            const float* p = &contour[i * 2];
+            const int last = vertices.Size() - 2;
+            if (last >= 0 && vertices[last] == p[0] && vertices[last + 1] == p[1])
+            {
+                continue;
+            }
+            vertices.Push(p[0]);
+            vertices.Push(p[1]);
+        }
+
+        while (vertices.Size() > 2 &&
+            vertices[0] == vertices[vertices.Size() - 2] && vertices[1] == vertices[vertices.Size() - 1])
+        {
+            vertices.SetSize(vertices.Size() - 2);
+        }
+
+        jc::Array<int>& indices = geometry->m_Indices;
+        indices.SetSize(0);
 
-        TESStesselator* tess = tessNewTess(0);
+        const int n = vertices.Size() / 2;
+        if (n < 3)
+        {
+            vertices.SetSize(0);
+            return true;
+        }
+
+        switch (classifyContour(vertices.Begin(), n))
+        {
+            case CONTOUR_CLASS_DEGENERATE:
+                vertices.SetSize(0);
+                return true;
+            case CONTOUR_CLASS_CONVEX:
+                ensureCapacity(indices, (n - 2) * 3);
+                for (int i = 1; i < n - 1; ++i)
+                {
+                    indices.Push(0);
+                    indices.Push(i);
+                    indices.Push(i + 1);
+                }
+                return true;
+            default:break;
+        }
+
+        if (n <= EAR_CLIP_MAX_VERTICES && isSimpleContour(vertices.Begin(), n) && earClip(vertices.Begin(), n, indices))
+        {
+            return true;
+        }
+
+        indices.SetSize(0);
+        return false;
+    }
+
+    void tessellateContours(GeometryCacheEntry* geometry)
+    {
+        const float* key        = geometry->m_Key.Begin();
+        const float* keyEnd     = geometry->m_Key.End();
+        const FillRule fillRule = (FillRule) (int) *key++;
+
+        // libtess2 can't be reset after a failed run, so the tessellator is created
+        // again for every path. With the arena that is only a bump allocation.
+        TessArena& arena = g_TessArena;
+        arena.reset();
+        TESStesselator* tess = tessNewTess(&arena.m_Alloc);
 
-        Mat2D identity;
-        addContours((void*) tess, identity);
+        const int numComponents = 2;
+        const int stride        = sizeof(float) * numComponents;
+        while (key < keyEnd)
+        {
+            int numVertices = (int) *key++;
+            tessAddContour(tess, numComponents, key, stride, numVertices);
+            key += numVertices * numComponents;
+        }
 
-        const int windingRule = m_FillRule == FillRule::nonZero ? TESS_WINDING_NONZERO : TESS_WINDING_ODD;
+        const int windingRule = fillRule == FillRule::nonZero ? TESS_WINDING_NONZERO : TESS_WINDING_ODD;
         const int elementType = TESS_POLYGONS;
         const int polySize    = 3;
         const int vertexSize  = 2;
 
+        geometry->m_Vertices.SetSize(0);
+        geometry->m_Indices.SetSize(0);
+
         if (tessTesselate(tess, windingRule, elementType, polySize, vertexSize, 0))
         {
             int              tessVerticesCount = tessGetVertexCount(tess);
@@ -125,16 +445,133 @@ namespace rive
             const TESSreal*  tessVertices      = tessGetVertices(tess);
             const TESSindex* tessElements      = tessGetElements(tess);
 
-            m_VertexBuffer = m_Context->m_RequestBufferCb(m_VertexBuffer, BUFFER_TYPE_VERTEX_BUFFER, (void*) tessVertices, tessVerticesCount * sizeof(float) * vertexSize, m_Context->m_BufferCbUserData);
-            m_IndexBuffer  = m_Context->m_RequestBufferCb(m_IndexBuffer, BUFFER_TYPE_INDEX_BUFFER, (void*) tessElements, tessElementsCount * sizeof(int) * polySize, m_Context->m_BufferCbUserData);
+            ensureCapacity(geometry->m_Vertices, tessVerticesCount * vertexSize);
+            ensureCapacity(geometry->m_Indices, tessElementsCount * polySize);
+            memcpy(geometry->m_Vertices.Begin(), tessVertices, tessVerticesCount * sizeof(float) * vertexSize);
+            memcpy(geometry->m_Indices.Begin(), tessElements, tessElementsCount * sizeof(int) * polySize);
+            geometry->m_Vertices.SetSize(tessVerticesCount * vertexSize);
+            geometry->m_Indices.SetSize(tessElementsCount * polySize);
+        }
+
+        // Everything was allocated from the arena, which is reset by the next path
+    }
+
+    ////////////////////////////////////////////////////////
+    // Tessellation - RenderPath
+    ////////////////////////////////////////////////////////
+
+    TessellationRenderPath::TessellationRenderPath(Context* ctx)
+    : SharedRenderPath(ctx)
+    , m_GeometryHash(0)
+    , m_Geometry(0)
+    , m_Bounds{ 0.0f, 0.0f, 0.0f, 0.0f }
+    {}
+
+    TessellationRenderPath::~TessellationRenderPath()
+    {
+        releaseGeometry(m_Context, m_Geometry);
+    }
+
+    void TessellationRenderPath::fillRule(FillRule value)
+    {
+        m_FillRule = value;
+    }
+
+    void TessellationRenderPath::addContours(jc::Array<float>& key, float* bounds, const Mat2D& m)
+    {
+        if (isContainer())
+        {
+            for (int i = 0; i < (int) m_SubPaths.size(); ++i)
+            {
+                TessellationRenderPath* sharedPath = (TessellationRenderPath*) m_SubPaths[i].path();
+                sharedPath->addContours(key, bounds, m_SubPaths[i].transform());
+            }
+            return;
+        }
+
+        // The first four vertices are the bounds of the contour
+        const float* contourVertices = m_Contour.Begin() + 8;
+        const uint32_t numVertices   = m_Contour.Size() / 2 - 4;
+
+        ensureCapacity(key, key.Size() + 1 + numVertices * 2);
+        key.Push((float) numVertices);
+
+        transformVertices(m, contourVertices, key.End(), numVertices, bounds);
+        key.SetSize(key.Size() + numVertices * 2);
+    }
+
+    void TessellationRenderPath::updateTesselation()
+    {
+        if (!isContourDirty())
+        {
+            return;
+        }
+
+        updateContour();
+        prepareBuffers();
+        if (resolveBuffers())
+        {
+            buildBuffers();
+        }
+        uploadBuffers(0);
+    }
+
+    void TessellationRenderPath::prepareBuffers()
+    {
+        // Subpaths add their contours to the container's key
+        m_GeometryKey.SetSize(0);
+        pushGrow(m_GeometryKey, (float) m_FillRule);
+        m_Bounds[0] = FLT_MAX;
+        m_Bounds[1] = FLT_MAX;
+        m_Bounds[2] = -FLT_MAX;
+        m_Bounds[3] = -FLT_MAX;
+        addContours(m_GeometryKey, m_Bounds, Mat2D());
+        m_GeometryHash = hashGeometryKey(m_GeometryKey);
+    }
+
+    bool TessellationRenderPath::resolveBuffers()
+    {
+        bool needsBuild;
+        m_Geometry = acquireGeometry(m_Context, m_Geometry, m_GeometryKey, m_GeometryHash, needsBuild);
+        return needsBuild;
+    }
+
+    void TessellationRenderPath::buildBuffers()
+    {
+        if (!triangulateSimpleContour(m_Geometry))
+        {
+            tessellateContours(m_Geometry);
+        }
+    }
+
+    void TessellationRenderPath::uploadBuffers(SharedRenderer* renderer)
+    {
+        // Shared geometry is uploaded by the first path that gets here
+        GeometryCacheEntry* geometry = m_Geometry;
+        if (geometry->m_IsUploaded || geometry->m_Indices.Size() == 0)
+        {
+            return;
         }
 
-        tessDeleteTess(tess);
+        geometry->m_VertexBuffer = m_Context->m_RequestBufferCb(geometry->m_VertexBuffer, BUFFER_TYPE_VERTEX_BUFFER,
+            geometry->m_Vertices.Begin(), geometry->m_Vertices.Size() * sizeof(float), m_Context->m_BufferCbUserData);
+        geometry->m_IndexBuffer  = m_Context->m_RequestBufferCb(geometry->m_IndexBuffer, BUFFER_TYPE_INDEX_BUFFER,
+            geometry->m_Indices.Begin(), geometry->m_Indices.Size() * sizeof(int), m_Context->m_BufferCbUserData);
+        geometry->m_IsUploaded   = true;
     }
 
     void TessellationRenderPath::drawMesh(SharedRenderer* renderer, const Mat2D& transform)
     {
-        updateTesselation();
+        requestContourError(renderer->getPathContourError(transform));
+
+        if (!renderer->defersPathUpdates())
+        {
+            updateTesselation();
+        }
+        else if (isContourDirty())
+        {
+            renderer->queuePath(this);
+        }
     }
     
     ////////////////////////////////////////////////////////
@@ -146,72 +583,89 @@ namespace rive
         m_Context = ctx;
     }
 
+    // Clip levels are nested in the stencil, each clip path is one increment on top
+    // of the paths below it. Paths that are still on the stack stay in the stencil,
+    // the ones that were popped are decremented away before the new ones are pushed.
     void TessellationRenderer::applyClipping()
     {
-        bool same = true;
-        if (m_ClipPaths.Size() == m_AppliedClips.Size())
+        m_IsClippingDirty = false;
+        setAppliedClipRect(m_ClipRect);
+
+        // The applied clip paths stay in the stencil while clipping is off, so they
+        // can be enabled again without drawing anything.
+        if (m_ClipPaths.Size() == 0)
         {
-            for (int i = 0; i < (int) m_ClipPaths.Size(); ++i)
+            if (m_IsClipping)
             {
-                const PathDescriptor& pdA = m_ClipPaths[i];
-                const PathDescriptor& pdB = m_AppliedClips[i];
-
-                if (pdA.m_Path != pdB.m_Path || (pdA.m_Transform == pdB.m_Transform))
-                {
-                    same = false;
-                    break;
-                }
+                PathDrawEvent evtClippingDisable = { .m_Type = EVENT_CLIPPING_DISABLE };
+                pushDrawEvent(evtClippingDisable);
+                m_IsClipping = false;
             }
-        }
-        else
-        {
-            same = false;
+            return;
         }
 
-        if (same)
+        const uint32_t prefix = getAppliedClipPrefix();
+        if (m_IsClipping && prefix == m_ClipPaths.Size() && prefix == m_AppliedClips.Size())
         {
             return;
         }
 
-        if (m_ClipPaths.Size() > 0)
+        // Without anything to keep, clearing is cheaper than popping every level. A path
+        // that changed since it was applied can't be popped, its old mesh is gone.
+        uint32_t level = prefix > 0 ? m_AppliedClips.Size() : 0;
+        for (uint32_t i = prefix; i < level; ++i)
         {
-            PathDrawEvent evtClippingBegin = { .m_Type = EVENT_CLIPPING_BEGIN };
-            pushDrawEvent(evtClippingBegin);
-
-            for (int i = 0; i < (int) m_ClipPaths.Size(); ++i)
+            const PathDescriptor& pd = m_AppliedClips[i];
+            if (((SharedRenderPath*) pd.m_Path)->contourVersion() != pd.m_Version)
             {
-                const PathDescriptor& pd = m_ClipPaths[i];
+                level = 0;
+                break;
+            }
+        }
 
-                PathDrawEvent evtDraw = {
-                    .m_Type           = EVENT_DRAW,
-                    .m_Path           = pd.m_Path,
-                    .m_TransformWorld = pd.m_Transform,
-                };
+        const uint32_t popLevel = level > 0 ? prefix : 0;
+        pushClippingBegin(level, popLevel, popLevel);
 
-                pushDrawEvent(evtDraw);
+        for (uint32_t i = level; i > popLevel; --i)
+        {
+            pushClipPath(m_AppliedClips[i - 1]);
+        }
 
-                ((TessellationRenderPath*) pd.m_Path)->drawMesh(this, m_Transform);
-            }
+        for (uint32_t i = popLevel; i < m_ClipPaths.Size(); ++i)
+        {
+            pushClipPath(m_ClipPaths[i]);
+        }
 
-            PathDrawEvent evtClippingEnd = {
-                .m_Type             = EVENT_CLIPPING_END,
-                .m_AppliedClipCount = (uint32_t) m_ClipPaths.Size(),
-            };
-            pushDrawEvent(evtClippingEnd);
+        PathDrawEvent evtClippingEnd = {
+            .m_Type             = EVENT_CLIPPING_END,
+            .m_AppliedClipCount = (uint32_t) m_ClipPaths.Size(),
+        };
+        pushDrawEvent(evtClippingEnd);
+        setAppliedClips();
+        m_IsClipping = true;
+    }
 
-            m_AppliedClips.SetCapacity(m_ClipPaths.Capacity());
-            m_AppliedClips.SetSize(0);
+    void TessellationRenderer::pushClipPath(const PathDescriptor& pd)
+    {
+        PathDrawEvent evtDraw = {
+            .m_Type              = EVENT_DRAW,
+            .m_Path              = pd.m_Path,
+            .m_TransformWorldIdx = internTransform(pd.m_Transform),
+        };
 
-            for (int i = 0; i < (int) m_ClipPaths.Size(); ++i)
-            {
-                m_AppliedClips.Push(m_ClipPaths[i]);
-            }
-        }
-        else
+        pushDrawEvent(evtDraw);
+
+        ((TessellationRenderPath*) pd.m_Path)->drawMesh(this, pd.m_Transform);
+    }
+
+    void TessellationRenderer::disableClipping()
+    {
+        if (m_IsClipping)
         {
-            PathDrawEvent evtClippingDisable = { .m_Type = EVENT_CLIPPING_DISABLE };
-            pushDrawEvent(evtClippingDisable);
+            PathDrawEvent evt = { .m_Type = EVENT_CLIPPING_DISABLE };
+            pushDrawEvent(evt);
         }
+        SharedRenderer::disableClipping();
     }
 
     void TessellationRenderer::drawPath(RenderPath* path, RenderPaint* paint)
@@ -220,7 +674,7 @@ namespace rive
         SharedRenderPath*     srph = (SharedRenderPath*) path;
         SharedRenderPaint*      rp = (SharedRenderPaint*) paint;
 
-        if (!rp->isVisible())
+        if (!rp->isVisible() || isPathCulled(srph, rp))
         {
             return;
         }
@@ -230,14 +684,23 @@ namespace rive
             applyClipping();
         }
 
+        // Solid fills go into the frame's batch, they carry their color per vertex
+        // and don't need a paint event. Everything else breaks the current batch.
+        if (m_IsBatchingSupported && rp->getStyle() != RenderPaintStyle::stroke && rp->m_Data.m_FillType == FILL_TYPE_SOLID)
+        {
+            p->drawMesh(this, m_Transform);
+            batchMesh(p, m_Transform, rp->m_Data);
+            return;
+        }
+
         setPaint(rp);
 
         if (rp->getStyle() != RenderPaintStyle::stroke)
         {
             PathDrawEvent evt = {
-                .m_Type           = EVENT_DRAW,
-                .m_Path           = path,
-                .m_TransformWorld = m_Transform
+                .m_Type              = EVENT_DRAW,
+                .m_Path              = path,
+                .m_TransformWorldIdx = internTransform(m_Transform)
             };
             pushDrawEvent(evt);
             p->drawMesh(this, m_Transform);
@@ -8,11 +8,26 @@
 
     Overview:
 
+        Shader program 'rive_batch':
+            Get shader desc: rive_batch_shader_desc(sg_query_backend());
+            Vertex shader: vs_batch
+                Attribute slots:
+                    ATTR_vs_batch_position = 0
+                    ATTR_vs_batch_color = 1
+                    ATTR_vs_batch_instanceTransform = 2
+                    ATTR_vs_batch_instanceOffset = 3
+                Uniform block 'vs_batch_params':
+                    C struct: vs_batch_params_t
+                    Bind slot: SLOT_vs_batch_params = 0
+            Fragment shader: fs_batch
+
         Shader program 'rive_debug_contour':
             Get shader desc: rive_debug_contour_shader_desc(sg_query_backend());
             Vertex shader: vs
                 Attribute slots:
                     ATTR_vs_position = 0
+                    ATTR_vs_instanceTransform = 1
+                    ATTR_vs_instanceOffset = 2
                 Uniform block 'vs_params':
                     C struct: vs_params_t
                     Bind slot: SLOT_vs_params = 0
@@ -26,6 +41,8 @@
             Vertex shader: vs
                 Attribute slots:
                     ATTR_vs_position = 0
+                    ATTR_vs_instanceTransform = 1
+                    ATTR_vs_instanceOffset = 2
                 Uniform block 'vs_params':
                     C struct: vs_params_t
                     Bind slot: SLOT_vs_params = 0
@@ -37,6 +54,7 @@
 
     Shader descriptor structs:
 
+        sg_shader rive_batch = sg_make_shader(rive_batch_shader_desc(sg_query_backend()));
         sg_shader rive_debug_contour = sg_make_shader(rive_debug_contour_shader_desc(sg_query_backend()));
         sg_shader rive_shader = sg_make_shader(rive_shader_shader_desc(sg_query_backend()));
 
@@ -46,6 +64,21 @@
             .layout = {
                 .attrs = {
                     [ATTR_vs_position] = { ... },
+                    [ATTR_vs_instanceTransform] = { ... },
+                    [ATTR_vs_instanceOffset] = { ... },
+                },
+            },
+            ...});
+
+    Vertex attribute locations for vertex shader 'vs_batch':
+
+        sg_pipeline pip = sg_make_pipeline(&(sg_pipeline_desc){
+            .layout = {
+                .attrs = {
+                    [ATTR_vs_batch_position] = { ... },
+                    [ATTR_vs_batch_color] = { ... },
+                    [ATTR_vs_batch_instanceTransform] = { ... },
+                    [ATTR_vs_batch_instanceOffset] = { ... },
                 },
             },
             ...});
@@ -82,6 +115,13 @@
         };
         sg_apply_uniforms(SG_SHADERSTAGE_[VS|FS], SLOT_fs_contour, &SG_RANGE(fs_contour));
 
+    Bind slot and C-struct for uniform block 'vs_batch_params':
+
+        vs_batch_params_t vs_batch_params = {
+            .projection = ...;
+        };
+        sg_apply_uniforms(SG_SHADERSTAGE_[VS|FS], SLOT_vs_batch_params, &SG_RANGE(vs_batch_params));
+
 */
 #include <stdint.h>
 #include <stdbool.h>
@@ -95,6 +135,8 @@
   #endif
 #endif
 #define ATTR_vs_position (0)
+#define ATTR_vs_instanceTransform (1)
+#define ATTR_vs_instanceOffset (2)
 #define SLOT_vs_params (0)
 #pragma pack(push,1)
 SOKOL_SHDC_ALIGN(16) typedef struct vs_params_t {
@@ -122,48 +164,78 @@ SOKOL_SHDC_ALIGN(16) typedef struct fs_contour_t {
     float solidColor[4];
 } fs_contour_t;
 #pragma pack(pop)
+#define ATTR_vs_batch_position (0)
+#define ATTR_vs_batch_color (1)
+#define ATTR_vs_batch_instanceTransform (2)
+#define ATTR_vs_batch_instanceOffset (3)
+#define SLOT_vs_batch_params (0)
+#pragma pack(push,1)
+SOKOL_SHDC_ALIGN(16) typedef struct vs_batch_params_t {
+    float projection[16];
+} vs_batch_params_t;
+#pragma pack(pop)
 /*
     #version 330
     
     uniform vec4 vs_params[12];
     layout(location = 0) in vec2 position;
+    layout(location = 1) in vec4 instanceTransform;
+    layout(location = 2) in vec2 instanceOffset;
     out vec2 vxPosition;
     
     void main()
     {
         vec4 _20 = vec4(position, 0.0, 1.0);
-        gl_Position = (mat4(vs_params[0], vs_params[1], vs_params[2], vs_params[3]) * mat4(vs_params[4], vs_params[5], vs_params[6], vs_params[7])) * _20;
+        vec4 _37 = mat4(vs_params[4], vs_params[5], vs_params[6], vs_params[7]) * _20;
+        vec2 _55 = (mat2(instanceTransform.xy, instanceTransform.zw) * _37.xy) + instanceOffset;
+        _37 = vec4(_55.x, _55.y, _37.z, _37.w);
+        gl_Position = mat4(vs_params[0], vs_params[1], vs_params[2], vs_params[3]) * _37;
         vxPosition = (mat4(vs_params[8], vs_params[9], vs_params[10], vs_params[11]) * _20).xy;
     }
     
 */
-static const char vs_source_glsl330[405] = {
+static const char vs_source_glsl330[653] = {
     0x23,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x20,0x33,0x33,0x30,0x0a,0x0a,0x75,0x6e,
     0x69,0x66,0x6f,0x72,0x6d,0x20,0x76,0x65,0x63,0x34,0x20,0x76,0x73,0x5f,0x70,0x61,
     0x72,0x61,0x6d,0x73,0x5b,0x31,0x32,0x5d,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,
     0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x30,0x29,0x20,0x69,
     0x6e,0x20,0x76,0x65,0x63,0x32,0x20,0x70,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x3b,
-    0x0a,0x6f,0x75,0x74,0x20,0x76,0x65,0x63,0x32,0x20,0x76,0x78,0x50,0x6f,0x73,0x69,
-    0x74,0x69,0x6f,0x6e,0x3b,0x0a,0x0a,0x76,0x6f,0x69,0x64,0x20,0x6d,0x61,0x69,0x6e,
-    0x28,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x76,0x65,0x63,0x34,0x20,0x5f,0x32,
-    0x30,0x20,0x3d,0x20,0x76,0x65,0x63,0x34,0x28,0x70,0x6f,0x73,0x69,0x74,0x69,0x6f,
-    0x6e,0x2c,0x20,0x30,0x2e,0x30,0x2c,0x20,0x31,0x2e,0x30,0x29,0x3b,0x0a,0x20,0x20,
-    0x20,0x20,0x67,0x6c,0x5f,0x50,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,
-    0x28,0x6d,0x61,0x74,0x34,0x28,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,
-    0x30,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x31,0x5d,
-    0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x32,0x5d,0x2c,0x20,
-    0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x33,0x5d,0x29,0x20,0x2a,0x20,
-    0x6d,0x61,0x74,0x34,0x28,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x34,
-    0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x35,0x5d,0x2c,
-    0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x36,0x5d,0x2c,0x20,0x76,
-    0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x37,0x5d,0x29,0x29,0x20,0x2a,0x20,
-    0x5f,0x32,0x30,0x3b,0x0a,0x20,0x20,0x20,0x20,0x76,0x78,0x50,0x6f,0x73,0x69,0x74,
-    0x69,0x6f,0x6e,0x20,0x3d,0x20,0x28,0x6d,0x61,0x74,0x34,0x28,0x76,0x73,0x5f,0x70,
-    0x61,0x72,0x61,0x6d,0x73,0x5b,0x38,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,
-    0x61,0x6d,0x73,0x5b,0x39,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,
-    0x73,0x5b,0x31,0x30,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,
-    0x5b,0x31,0x31,0x5d,0x29,0x20,0x2a,0x20,0x5f,0x32,0x30,0x29,0x2e,0x78,0x79,0x3b,
-    0x0a,0x7d,0x0a,0x0a,0x00,
+    0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,
+    0x20,0x3d,0x20,0x31,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x34,0x20,0x69,0x6e,
+    0x73,0x74,0x61,0x6e,0x63,0x65,0x54,0x72,0x61,0x6e,0x73,0x66,0x6f,0x72,0x6d,0x3b,
+    0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,
+    0x20,0x3d,0x20,0x32,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x32,0x20,0x69,0x6e,
+    0x73,0x74,0x61,0x6e,0x63,0x65,0x4f,0x66,0x66,0x73,0x65,0x74,0x3b,0x0a,0x6f,0x75,
+    0x74,0x20,0x76,0x65,0x63,0x32,0x20,0x76,0x78,0x50,0x6f,0x73,0x69,0x74,0x69,0x6f,
+    0x6e,0x3b,0x0a,0x0a,0x76,0x6f,0x69,0x64,0x20,0x6d,0x61,0x69,0x6e,0x28,0x29,0x0a,
+    0x7b,0x0a,0x20,0x20,0x20,0x20,0x76,0x65,0x63,0x34,0x20,0x5f,0x32,0x30,0x20,0x3d,
+    0x20,0x76,0x65,0x63,0x34,0x28,0x70,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x2c,0x20,
+    0x30,0x2e,0x30,0x2c,0x20,0x31,0x2e,0x30,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x76,
+    0x65,0x63,0x34,0x20,0x5f,0x33,0x37,0x20,0x3d,0x20,0x6d,0x61,0x74,0x34,0x28,0x76,
+    0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x34,0x5d,0x2c,0x20,0x76,0x73,0x5f,
+    0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x35,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,
+    0x72,0x61,0x6d,0x73,0x5b,0x36,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,
+    0x6d,0x73,0x5b,0x37,0x5d,0x29,0x20,0x2a,0x20,0x5f,0x32,0x30,0x3b,0x0a,0x20,0x20,
+    0x20,0x20,0x76,0x65,0x63,0x32,0x20,0x5f,0x35,0x35,0x20,0x3d,0x20,0x28,0x6d,0x61,
+    0x74,0x32,0x28,0x69,0x6e,0x73,0x74,0x61,0x6e,0x63,0x65,0x54,0x72,0x61,0x6e,0x73,
+    0x66,0x6f,0x72,0x6d,0x2e,0x78,0x79,0x2c,0x20,0x69,0x6e,0x73,0x74,0x61,0x6e,0x63,
+    0x65,0x54,0x72,0x61,0x6e,0x73,0x66,0x6f,0x72,0x6d,0x2e,0x7a,0x77,0x29,0x20,0x2a,
+    0x20,0x5f,0x33,0x37,0x2e,0x78,0x79,0x29,0x20,0x2b,0x20,0x69,0x6e,0x73,0x74,0x61,
+    0x6e,0x63,0x65,0x4f,0x66,0x66,0x73,0x65,0x74,0x3b,0x0a,0x20,0x20,0x20,0x20,0x5f,
+    0x33,0x37,0x20,0x3d,0x20,0x76,0x65,0x63,0x34,0x28,0x5f,0x35,0x35,0x2e,0x78,0x2c,
+    0x20,0x5f,0x35,0x35,0x2e,0x79,0x2c,0x20,0x5f,0x33,0x37,0x2e,0x7a,0x2c,0x20,0x5f,
+    0x33,0x37,0x2e,0x77,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x67,0x6c,0x5f,0x50,0x6f,
+    0x73,0x69,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x6d,0x61,0x74,0x34,0x28,0x76,0x73,
+    0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x30,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,
+    0x61,0x72,0x61,0x6d,0x73,0x5b,0x31,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,
+    0x61,0x6d,0x73,0x5b,0x32,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,
+    0x73,0x5b,0x33,0x5d,0x29,0x20,0x2a,0x20,0x5f,0x33,0x37,0x3b,0x0a,0x20,0x20,0x20,
+    0x20,0x76,0x78,0x50,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x28,0x6d,
+    0x61,0x74,0x34,0x28,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x38,0x5d,
+    0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x39,0x5d,0x2c,0x20,
+    0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x31,0x30,0x5d,0x2c,0x20,0x76,
+    0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x31,0x31,0x5d,0x29,0x20,0x2a,0x20,
+    0x5f,0x32,0x30,0x29,0x2e,0x78,0x79,0x3b,0x0a,0x7d,0x0a,0x0a,0x00,
 };
 /*
     #version 330
@@ -380,9 +452,106 @@ static const char debug_contour_source_glsl330[215] = {
     0x74,0x6f,0x75,0x72,0x5b,0x31,0x5d,0x2e,0x77,0x29,0x29,0x2c,0x20,0x31,0x2e,0x30,
     0x29,0x3b,0x0a,0x7d,0x0a,0x0a,0x00,
 };
+/*
+    #version 330
+    
+    uniform vec4 vs_batch_params[4];
+    layout(location = 2) in vec4 instanceTransform;
+    layout(location = 0) in vec2 position;
+    layout(location = 3) in vec2 instanceOffset;
+    out vec4 vxColor;
+    layout(location = 1) in vec4 color;
+    
+    void main()
+    {
+        gl_Position = mat4(vs_batch_params[0], vs_batch_params[1], vs_batch_params[2], vs_batch_params[3]) * vec4((mat2(instanceTransform.xy, instanceTransform.zw) * position) + instanceOffset, 0.0, 1.0);
+        vxColor = color;
+    }
+    
+*/
+static const char vs_batch_source_glsl330[474] = {
+    0x23,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x20,0x33,0x33,0x30,0x0a,0x0a,0x75,0x6e,
+    0x69,0x66,0x6f,0x72,0x6d,0x20,0x76,0x65,0x63,0x34,0x20,0x76,0x73,0x5f,0x62,0x61,
+    0x74,0x63,0x68,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x34,0x5d,0x3b,0x0a,0x6c,
+    0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,
+    0x20,0x32,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x34,0x20,0x69,0x6e,0x73,0x74,
+    0x61,0x6e,0x63,0x65,0x54,0x72,0x61,0x6e,0x73,0x66,0x6f,0x72,0x6d,0x3b,0x0a,0x6c,
+    0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,
+    0x20,0x30,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x32,0x20,0x70,0x6f,0x73,0x69,
+    0x74,0x69,0x6f,0x6e,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,
+    0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x33,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,
+    0x63,0x32,0x20,0x69,0x6e,0x73,0x74,0x61,0x6e,0x63,0x65,0x4f,0x66,0x66,0x73,0x65,
+    0x74,0x3b,0x0a,0x6f,0x75,0x74,0x20,0x76,0x65,0x63,0x34,0x20,0x76,0x78,0x43,0x6f,
+    0x6c,0x6f,0x72,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,
+    0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x31,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,
+    0x34,0x20,0x63,0x6f,0x6c,0x6f,0x72,0x3b,0x0a,0x0a,0x76,0x6f,0x69,0x64,0x20,0x6d,
+    0x61,0x69,0x6e,0x28,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x67,0x6c,0x5f,0x50,
+    0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x6d,0x61,0x74,0x34,0x28,0x76,
+    0x73,0x5f,0x62,0x61,0x74,0x63,0x68,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x30,
+    0x5d,0x2c,0x20,0x76,0x73,0x5f,0x62,0x61,0x74,0x63,0x68,0x5f,0x70,0x61,0x72,0x61,
+    0x6d,0x73,0x5b,0x31,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x62,0x61,0x74,0x63,0x68,0x5f,
+    0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x32,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x62,0x61,
+    0x74,0x63,0x68,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x33,0x5d,0x29,0x20,0x2a,
+    0x20,0x76,0x65,0x63,0x34,0x28,0x28,0x6d,0x61,0x74,0x32,0x28,0x69,0x6e,0x73,0x74,
+    0x61,0x6e,0x63,0x65,0x54,0x72,0x61,0x6e,0x73,0x66,0x6f,0x72,0x6d,0x2e,0x78,0x79,
+    0x2c,0x20,0x69,0x6e,0x73,0x74,0x61,0x6e,0x63,0x65,0x54,0x72,0x61,0x6e,0x73,0x66,
+    0x6f,0x72,0x6d,0x2e,0x7a,0x77,0x29,0x20,0x2a,0x20,0x70,0x6f,0x73,0x69,0x74,0x69,
+    0x6f,0x6e,0x29,0x20,0x2b,0x20,0x69,0x6e,0x73,0x74,0x61,0x6e,0x63,0x65,0x4f,0x66,
+    0x66,0x73,0x65,0x74,0x2c,0x20,0x30,0x2e,0x30,0x2c,0x20,0x31,0x2e,0x30,0x29,0x3b,
+    0x0a,0x20,0x20,0x20,0x20,0x76,0x78,0x43,0x6f,0x6c,0x6f,0x72,0x20,0x3d,0x20,0x63,
+    0x6f,0x6c,0x6f,0x72,0x3b,0x0a,0x7d,0x0a,0x0a,0x00,
+};
+/*
+    #version 330
+    
+    layout(location = 0) out vec4 fragColor;
+    in vec4 vxColor;
+    
+    void main()
+    {
+        fragColor = vec4(vxColor.xyz * vxColor.w, vxColor.w);
+    }
+    
+*/
+static const char fs_batch_source_glsl330[149] = {
+    0x23,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x20,0x33,0x33,0x30,0x0a,0x0a,0x6c,0x61,
+    0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,
+    0x30,0x29,0x20,0x6f,0x75,0x74,0x20,0x76,0x65,0x63,0x34,0x20,0x66,0x72,0x61,0x67,
+    0x43,0x6f,0x6c,0x6f,0x72,0x3b,0x0a,0x69,0x6e,0x20,0x76,0x65,0x63,0x34,0x20,0x76,
+    0x78,0x43,0x6f,0x6c,0x6f,0x72,0x3b,0x0a,0x0a,0x76,0x6f,0x69,0x64,0x20,0x6d,0x61,
+    0x69,0x6e,0x28,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x66,0x72,0x61,0x67,0x43,
+    0x6f,0x6c,0x6f,0x72,0x20,0x3d,0x20,0x76,0x65,0x63,0x34,0x28,0x76,0x78,0x43,0x6f,
+    0x6c,0x6f,0x72,0x2e,0x78,0x79,0x7a,0x20,0x2a,0x20,0x76,0x78,0x43,0x6f,0x6c,0x6f,
+    0x72,0x2e,0x77,0x2c,0x20,0x76,0x78,0x43,0x6f,0x6c,0x6f,0x72,0x2e,0x77,0x29,0x3b,
+    0x0a,0x7d,0x0a,0x0a,0x00,
+};
 #if !defined(SOKOL_GFX_INCLUDED)
   #error "Please include sokol_gfx.h before shaders.glsl.h"
 #endif
+static inline const sg_shader_desc* rive_batch_shader_desc(sg_backend backend) {
+  if (backend == SG_BACKEND_GLCORE33) {
+    static sg_shader_desc desc;
+    static bool valid;
+    if (!valid) {
+      valid = true;
+      desc.attrs[0].name = "position";
+      desc.attrs[1].name = "color";
+      desc.attrs[2].name = "instanceTransform";
+      desc.attrs[3].name = "instanceOffset";
+      desc.vs.source = vs_batch_source_glsl330;
+      desc.vs.entry = "main";
+      desc.vs.uniform_blocks[0].size = 64;
+      desc.vs.uniform_blocks[0].uniforms[0].name = "vs_batch_params";
+      desc.vs.uniform_blocks[0].uniforms[0].type = SG_UNIFORMTYPE_FLOAT4;
+      desc.vs.uniform_blocks[0].uniforms[0].array_count = 4;
+      desc.fs.source = fs_batch_source_glsl330;
+      desc.fs.entry = "main";
+      desc.label = "rive_batch_shader";
+    }
+    return &desc;
+  }
+  return 0;
+}
 static inline const sg_shader_desc* rive_debug_contour_shader_desc(sg_backend backend) {
   if (backend == SG_BACKEND_GLCORE33) {
     static sg_shader_desc desc;
@@ -390,6 +559,8 @@ static inline const sg_shader_desc* rive_debug_contour_shader_desc(sg_backend ba
     if (!valid) {
       valid = true;
       desc.attrs[0].name = "position";
+      desc.attrs[1].name = "instanceTransform";
+      desc.attrs[2].name = "instanceOffset";
       desc.vs.source = vs_source_glsl330;
       desc.vs.entry = "main";
       desc.vs.uniform_blocks[0].size = 192;
@@ -415,6 +586,8 @@ static inline const sg_shader_desc* rive_shader_shader_desc(sg_backend backend)
     if (!valid) {
       valid = true;
       desc.attrs[0].name = "position";
+      desc.attrs[1].name = "instanceTransform";
+      desc.attrs[2].name = "instanceOffset";
       desc.vs.source = vs_source_glsl330;
       desc.vs.entry = "main";
       desc.vs.uniform_blocks[0].size = 192;